@@ -11,13 +11,30 @@
 // - Utilizar passagem por referencia (ponteiros) para modificar dados e
 //   passagem por valor/referencia constante (const) para apenas ler.
 // - Foco em: Design de software, modularizacao, const correctness, logica de jogo.
+//
+// COMPILACAO: gcc -std=c11 -O2 -pthread Desafiowar.c -o war -lrt
 // ============================================================================
 
+// Habilita as funcoes POSIX (threads, relogios) ao compilar com -std=c11.
+#define _POSIX_C_SOURCE 200809L
+
 // Inclusao das bibliotecas padrao necessarias para entrada/saida, alocacao de memoria, manipulacao de strings e tempo.
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
+#include <stdarg.h>
+#include <limits.h>
 #include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // --- Constantes Globais ---
 // Definem valores fixos para o numero de territorios, missoes e tamanho maximo de strings, facilitando a manutencao.
@@ -28,6 +45,62 @@
 #define MAX_COR 10
 #define MAX_VIDA 1000
 #define MAX_TROPAS_ATAQUE 100
+#define NUM_CONTINENTES 6
+#define MAX_MISSOES 64
+#define MAX_BYTECODE 48
+#define MAX_DESCRICAO 80
+#define MAX_LINHA_MISSAO 256
+#define MAX_TROPAS_HIST 64
+#define TAMANHO_BLOCO 8
+#define NUM_BLOCOS ((NUM_TERRITORIOS + TAMANHO_BLOCO - 1) / TAMANHO_BLOCO)
+#define MAX_HISTORICO 64
+#define PLACAR_MAX_JOGADORES 256
+#define PLACAR_NUM_FRAGMENTOS 32
+#define PLACAR_TENTATIVAS_LEITURA 64
+#define PLACAR_TOP 10
+#define PLACAR_INTERVALO_SALVAR 30
+#define EXPORTACAO_LINHAS_BLOCO 4096
+#define EXPORTACAO_BUFFER_ARQUIVO (1 << 20)
+#define EXPORTACAO_VERSAO 1
+#define SIMULACAO_MAX_TURNOS 200
+#define VARREDURA_PARTIDAS 200
+#define VARREDURA_PASSO_VIDA 100
+#define VARREDURA_CACHE "varredura.cache"
+#define INFLUENCIA_CORES (NUM_CORES + 1)
+#define INFLUENCIA_RAIO 3
+#define INFLUENCIA_ESCALA 8
+#define PRECALCULO_TAREFAS 3
+#define PRECALCULO_SIMULACOES_CONQUISTA 2000
+#define PRECALCULO_SIMULACOES_MISSAO 300
+#define MAX_LINHA_ENTRADA 64
+#define MAX_LINHA_PROMPT 128
+#define BLITZ_CACHE 32
+#define TRANSMISSAO_MAGICO 0x54524157u    // "WART"
+#define TRANSMISSAO_VERSAO 2
+#define TRANSMISSAO_SLOTS 1024
+#define TRANSMISSAO_PALAVRAS 7
+#define TRANSMISSAO_BYTES (TRANSMISSAO_PALAVRAS * 8)
+#define TRANSMISSAO_INTERVALO_QUADRO 8
+#define TRANSMISSAO_ESPERA_MS 50
+#define TRANSMISSAO_ESPERAS_VERIFICACAO 20  // Esperas seguidas (~1 s) antes de conferir se o jogo ainda existe
+#define AUTOJOGO_MAGICO 0x41524157u       // "WARA"
+#define AUTOJOGO_VERSAO 1
+#define AUTOJOGO_TAMANHO_REGISTRO 512
+#define FINAL_MAX_ALVOS 4
+#define FINAL_MAX_ORIGENS 4
+#define FINAL_MAX_TROPAS_ORIGEM 255
+#define FINAL_MAX_TROPAS_ALVO 31
+#define FINAL_MAX_FAIXA_VIDA 127
+#define FINAL_MAX_ESTADOS (1 << 20)
+#define INICIOS_MAGICO 0x49524157u        // "WARI"
+#define INICIOS_VERSAO 2
+#define INICIOS_BYTES_TERRITORIO 6
+#define INICIOS_TAMANHO_REGISTRO (NUM_TERRITORIOS * INICIOS_BYTES_TERRITORIO)
+#define INICIOS_CABECALHO 20
+#define INICIOS_PADRAO 100000
+#define INICIOS_EQUILIBRIO_PADRAO 25
+#define INICIOS_LOTE 64
+#define INICIOS_MAX_TENTATIVAS 1000
 
 // --- Estrutura de Dados ---
 // Define a estrutura para um territorio, contendo seu nome, a cor do exercito que o domina e o numero de tropas.
@@ -50,6 +123,7 @@ typedef struct {
     int territoriosConquistados;
     int batalhasVencidas;
     int batalhasPerdidas;
+    int idPlacar;       // Posicao no placar global (0 = nao participa)
 } Jogador;
 
 // Estrutura para estatisticas dos exercitos
@@ -62,12 +136,561 @@ typedef struct {
     int pontos;
 } EstatisticaExercito;
 
+// Estrutura para um continente: faixa contigua de indices no vetor de territorios
+typedef struct {
+    const char* nome;
+    int inicio;
+    int quantidade;
+} Continente;
+
+// Instrucoes do bytecode de missoes. Cada instrucao e uma condicao que precisa ser verdadeira;
+// o interpretador retorna 0 na primeira que falhar e 1 ao chegar em OP_FIM.
+typedef enum {
+    OP_FIM = 0,
+    OP_SEM_COR,             // [cor]            nenhum territorio da cor
+    OP_POSSUI,              // [n lo][n hi]     jogador possui >= n territorios
+    OP_POSSUI_COM_TROPAS,   // [n lo][n hi][t]  jogador possui >= n territorios com >= t tropas
+    OP_CONTINENTE           // [continente]     jogador possui o continente inteiro
+} OpcodeMissao;
+
+// Missao compilada a partir da DSL de missoes
+typedef struct {
+    char descricao[MAX_DESCRICAO];
+    unsigned char codigo[MAX_BYTECODE];
+    int tamanho;
+} MissaoCompilada;
+
+// Catalogo de missoes carregado na inicializacao
+typedef struct {
+    MissaoCompilada missoes[MAX_MISSOES];
+    int quantidade;
+} CatalogoMissoes;
+
+// Resumo do estado de posse do mapa, extraido uma vez e reutilizado para avaliar varias missoes
+typedef struct {
+    int territoriosPorCor[NUM_CORES];
+    int territoriosJogador;
+    int continenteJogador[NUM_CONTINENTES];
+    int jogadorComTropas[MAX_TROPAS_HIST + 1]; // [t] = territorios do jogador com pelo menos t tropas
+} EstadoPosse;
+
+// Situacao de um ataque apos as validacoes
+typedef enum {
+    ATAQUE_REALIZADO = 0,
+    ATAQUE_TROPAS_INSUFICIENTES,
+    ATAQUE_TERRITORIO_PROPRIO,
+    ATAQUE_SEM_MEMORIA          // Copia de estado (copy-on-write) falhou
+} StatusAtaque;
+
+// Resultado de uma batalha, preenchido por resolverAtaque() sem nenhuma saida na tela
+typedef struct {
+    StatusAtaque status;
+    int dadoAtacante;
+    int dadoDefensor;
+    int forcaAtacante;
+    int forcaDefensor;
+    int atacanteVenceu;
+    int dano;
+    int conquistou;
+} ResultadoBatalha;
+
+// Resultado de um ataque relampago (varias batalhas resolvidas de uma vez)
+typedef struct {
+    StatusAtaque status;
+    int rodadas;
+    int vitorias;
+    int derrotas;
+    int conquistou;
+} ResultadoBlitz;
+
+// Distribuicao dos desfechos de um ataque relampago: pares (vitorias, derrotas) finais com
+// probabilidade acumulada, para sortear o desfecho com um unico numero aleatorio.
+// chance[w] e a chance de vencer a rodada com w vitorias ja obtidas, usada para sortear a ordem.
+// A chave identifica tudo que determina a distribuicao.
+typedef struct {
+    int valida;
+    int vantagemBase, tropasDefensor, vitoriasNecessarias, derrotasPermitidas, maxRodadas;
+    int quantidade;
+    int capacidade;
+    int* vitorias;
+    int* derrotas;
+    double* acumulada;
+    double* chance;
+} DistribuicaoBlitz;
+
+// Bloco de territorios compartilhado entre estados ate que algum deles precise altera-lo
+typedef struct {
+    int referencias;
+    Territorio territorios[TAMANHO_BLOCO];
+} BlocoTerritorios;
+
+// Tabela de blocos do mapa; tambem compartilhada, para que o snapshot seja O(1)
+typedef struct {
+    int referencias;
+    BlocoTerritorios* blocos[NUM_BLOCOS];
+} TabelaBlocos;
+
+// Estado de jogo persistente com copia-na-escrita (copy-on-write).
+// Snapshots compartilham a tabela e os blocos; escrever em um territorio copia apenas
+// a tabela (se compartilhada) e o bloco que o contem.
+typedef struct {
+    TabelaBlocos* tabela;
+    Jogador jogador;
+} EstadoJogo;
+
+// Pilha de estados para desfazer/refazer ataques
+typedef struct {
+    EstadoJogo estados[MAX_HISTORICO];
+    int quantidade;
+    int atual;
+} HistoricoEstados;
+
+// Jogador registrado no placar global. 'estado' so passa a PRONTO depois que o nome foi escrito.
+typedef struct {
+    _Atomic int estado;
+    unsigned long hash;
+    char nome[MAX_NOME];
+} EntradaPlacar;
+
+// Contadores do placar. Em geral so a thread que reservou o fragmento escreve nele, mas as somas
+// sao atomicas para que threads sem fragmento proprio possam dividi-lo. Os contadores de escritas
+// iniciadas/concluidas validam a leitura do fragmento (seqlock com varios escritores).
+typedef struct {
+    _Atomic int ocupado;
+    _Atomic unsigned long escritasIniciadas;
+    _Atomic unsigned long escritasConcluidas;
+    _Atomic long pontos[PLACAR_MAX_JOGADORES];
+    _Atomic long batalhasVencidas[PLACAR_MAX_JOGADORES];
+    _Atomic long territoriosConquistados[PLACAR_MAX_JOGADORES];
+} FragmentoPlacar;
+
+// Placar global compartilhado por todos os jogos do processo.
+typedef struct {
+    EntradaPlacar jogadores[PLACAR_MAX_JOGADORES];
+    FragmentoPlacar fragmentos[PLACAR_NUM_FRAGMENTOS];
+} PlacarGlobal;
+
+// Linha do placar consolidada para exibicao e gravacao
+typedef struct {
+    char nome[MAX_NOME];
+    long pontos;
+    long batalhasVencidas;
+    long territoriosConquistados;
+} PosicaoPlacar;
+
+// Thread que grava o placar periodicamente
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    int ativa;
+    int encerrar;
+    int intervaloSegundos;
+    char caminho[256];
+} PersistenciaPlacar;
+
+// Exportador de batalhas em colunas. Cada coluna acumula ate EXPORTACAO_LINHAS_BLOCO valores
+// e o bloco inteiro e gravado coluna a coluna em escritas sequenciais grandes.
+// Um exportador pertence a uma unica thread. So o jogo interativo o ativa: as batalhas da
+// varredura, do autojogo e das analises nao sao exportadas (o autojogo grava suas proprias partidas).
+typedef struct {
+    short poderAtacante[EXPORTACAO_LINHAS_BLOCO];
+    short poderDefensor[EXPORTACAO_LINHAS_BLOCO];
+    short tropasAtaque[EXPORTACAO_LINHAS_BLOCO];
+    short tropasDefensor[EXPORTACAO_LINHAS_BLOCO];
+    unsigned char dadoAtacante[EXPORTACAO_LINHAS_BLOCO];
+    unsigned char dadoDefensor[EXPORTACAO_LINHAS_BLOCO];
+    short forcaAtacante[EXPORTACAO_LINHAS_BLOCO];
+    short forcaDefensor[EXPORTACAO_LINHAS_BLOCO];
+    short dano[EXPORTACAO_LINHAS_BLOCO];
+    unsigned char conquistou[EXPORTACAO_LINHAS_BLOCO];
+    int turno[EXPORTACAO_LINHAS_BLOCO];
+} ColunasBatalha;
+
+typedef struct {
+    ColunasBatalha colunas;
+    int linhas;             // Linhas no bloco atual
+    long totalLinhas;
+    int turnoAtual;         // Turno gravado nas proximas batalhas
+    FILE* binario;
+    FILE* csv;              // Opcional (NULL)
+} ExportadorBatalhas;
+
+// Descricao de uma coluna: nome, largura em bytes e posicao dentro de ColunasBatalha
+typedef struct {
+    const char* nome;
+    size_t largura;
+    size_t deslocamento;
+} DescricaoColuna;
+
+// Agregados calculados a partir de um arquivo exportado
+typedef struct {
+    long batalhas;
+    long vitoriasAtacante;
+    long conquistas;
+    long somaDano;
+    long somaForcaAtacante;
+    long somaForcaDefensor;
+    long somaTropasAtaque;
+    int ultimoTurno;
+} ResumoBatalhas;
+
+// Constantes da formula de combate de resolverAtaque()
+typedef struct {
+    int divisorPoder;       // Bonus de forca = poder / divisorPoder
+    int danoPorTropa;       // Dano da vitoria = tropasAtaque * danoPorTropa
+    int divisorConquista;   // Territorio conquistado recebe vida e poder do atacante / divisorConquista
+} ParametrosCombate;
+
+// Um ponto da varredura: alocacao de vida/poder, regras e missao, com o resultado das partidas
+typedef struct {
+    int vida;
+    ParametrosCombate regras;
+    int idMissao;
+    unsigned long long hash;
+    int partidas;
+    int vitorias;
+    int emCache;
+} PontoVarredura;
+
+// Resultado guardado no arquivo de cache da varredura
+typedef struct {
+    unsigned long long hash;
+    int partidas;
+    int vitorias;
+} EntradaCacheVarredura;
+
+// Lista de pontos compartilhada pelas threads da varredura; cada thread pega o proximo ponto livre
+typedef struct {
+    PontoVarredura* pontos;
+    int quantidade;
+    _Atomic int proximo;
+    int maxTurnos;
+} TrabalhoVarredura;
+
+// Grafo de vizinhanca entre territorios em formato compacto (CSR): os vizinhos do territorio t
+// ficam em vizinhos[inicio[t]] ate vizinhos[inicio[t + 1] - 1]. Serve tanto ao mapa de 42
+// territorios quanto a mapas gerados bem maiores.
+typedef struct {
+    int numTerritorios;
+    int* inicio;
+    int* vizinhos;
+} GrafoTerritorios;
+
+// Mapa de influencia: a forca de cada territorio se espalha ate INFLUENCIA_RAIO vizinhos de distancia,
+// caindo pela metade a cada passo. influencia[t * INFLUENCIA_CORES + c] e a influencia da cor c
+// sobre t, em inteiros multiplicados por INFLUENCIA_ESCALA para que somar e subtrair seja exato.
+// A ultima cor (NUM_CORES) agrupa cores fora da tabela, como a cor padrao do jogador.
+typedef struct {
+    const GrafoTerritorios* grafo;
+    long* influencia;
+    signed char* dono;
+    int* forca;
+    int* marca;             // Auxiliares da busca em largura, reaproveitados entre atualizacoes
+    int* fila;
+    int carimbo;
+} MapaInfluencia;
+
+// Analises calculadas em segundo plano enquanto o jogador decide (um bit por tarefa)
+enum {
+    PRECALCULO_ESTATISTICAS = 1 << 0,
+    PRECALCULO_RECOMENDACAO = 1 << 1,
+    PRECALCULO_MISSAO = 1 << 2
+};
+
+// Estado do laco assincrono: copia do jogo analisada pelas threads de trabalho, resultados
+// publicados sob 'trava' e a linha digitada pelo jogador, lida por uma thread propria que vive
+// o jogo inteiro. 'sinal' acorda o laco principal para resultados prontos e para entrada, e a
+// thread leitora quando uma linha e pedida.
+typedef struct {
+    pthread_t tarefas[PRECALCULO_TAREFAS];
+    pthread_t leitor;
+    int leitorAtivo;        // 0 = sem thread leitora; as linhas sao lidas na hora
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    int tarefasAtivas;
+    _Atomic int cancelar;
+    
+    // Copia do estado analisado (somente leitura para as tarefas)
+    Territorio mapa[NUM_TERRITORIOS];
+    Jogador jogador;
+    int idMissao;
+    unsigned long long semente;
+    
+    // Resultados; cada tarefa escreve apenas nos seus campos antes de marcar 'prontos'
+    int prontos;
+    int avisados;
+    EstatisticaExercito estatisticas[NUM_CORES];
+    int temRecomendacao;
+    int origem, destino, tropas;
+    double chanceVitoria;
+    double chanceConquista;
+    double chanceMissao;
+    
+    // Entrada do jogador
+    char linha[MAX_LINHA_ENTRADA];
+    int linhaPedida;        // O laco principal espera uma linha
+    int linhaPronta;        // 1 = linha lida, -1 = fim da entrada
+    int encerrarLeitor;
+} PreCalculo;
+
+// Transmissao para espectadores: anel em memoria compartilhada com um produtor (o jogo) e
+// varios leitores (processos espectadores). Cada slot ocupa 64 bytes e tem um numero de
+// sequencia proprio: 0 enquanto o produtor escreve e (mensagem + 1) quando completo.
+// O leitor copia o slot e confere a sequencia antes e depois; se mudou, foi sobrescrito.
+// O produtor nunca espera por leitores: quem ficar mais de TRANSMISSAO_SLOTS para tras
+// perde mensagens e volta a sincronizar no proximo quadro completo.
+typedef enum {
+    TRANSMISSAO_QUADRO = 1,         // Inicio de quadro completo (todos os territorios + jogador)
+    TRANSMISSAO_TERRITORIO,         // Campos de um territorio (apenas os indicados na mascara)
+    TRANSMISSAO_JOGADOR,            // Pontuacao e estatisticas do jogador
+    TRANSMISSAO_FIM_QUADRO,         // Quadro completo terminado
+    TRANSMISSAO_ENCERRAMENTO        // O jogo terminou
+} TipoTransmissao;
+
+// Bits da mascara de campos alterados
+#define CAMPO_TROPAS 1
+#define CAMPO_VIDA 2
+#define CAMPO_PODER 4
+#define CAMPO_COR 8
+#define CAMPO_NOME 16
+#define CAMPO_PONTOS 1
+#define CAMPO_VENCIDAS 2
+#define CAMPO_PERDIDAS 4
+#define CAMPO_CONQUISTADOS 8
+
+typedef struct {
+    _Alignas(64) atomic_ullong sequencia;
+    atomic_ullong dados[TRANSMISSAO_PALAVRAS];
+} SlotTransmissao;
+
+typedef struct {
+    unsigned int magico;
+    unsigned int versao;
+    unsigned int numSlots;
+    int produtor;                   // PID do jogo, para o espectador perceber se ele parou sem encerrar
+    atomic_ullong cabeca;           // Numero da proxima mensagem a ser escrita
+    SlotTransmissao slots[];
+} AnelTransmissao;
+
+// Lado do jogo: guarda o ultimo estado publicado para emitir apenas as diferencas.
+// 'mapa' e o mapa do jogo transmitido; batalhas sobre outros mapas nao sao publicadas.
+typedef struct {
+    AnelTransmissao* anel;
+    size_t tamanho;
+    char nome[64];
+    const Territorio* mapa;
+    int turnoAtual;
+    Territorio anterior[NUM_TERRITORIOS];
+    Jogador jogadorAnterior;
+    int publicacoes;
+} Transmissor;
+
+// Politicas de escolha de ataque do gerador de autojogo
+typedef enum {
+    POLITICA_GULOSA,        // escolherAtaqueAutomatico()
+    POLITICA_ALEATORIA      // origem, destino e tropas sorteados entre os ataques validos
+} PoliticaAutojogo;
+
+// Trabalho de uma thread do gerador de autojogo: joga suas partidas e grava seu proprio arquivo
+typedef struct {
+    pthread_t thread;
+    int iniciada;
+    PoliticaAutojogo politica;
+    int partidas;
+    unsigned long long semente;
+    char caminho[256];
+    long amostras;
+    int vitorias;
+    int sucesso;
+} TrabalhoAutojogo;
+
+// Posicao de final de jogo para o solucionador exato. Os alvos sao os territorios que faltam
+// para a missao; a vida de cada alvo e medida em faixas de danoPorTropa (cada vitoria com t
+// tropas tira exatamente t faixas). Os ataques partem dos FINAL_MAX_ORIGENS territorios do
+// jogador com mais tropas; territorios conquistados durante a analise nao atacam.
+typedef struct {
+    int numOrigens;
+    int origens[FINAL_MAX_ORIGENS];
+    int bonusOrigem[FINAL_MAX_ORIGENS];     // poder / divisorPoder
+    int tropasOrigem[FINAL_MAX_ORIGENS];
+    int grupoOrigem[FINAL_MAX_ORIGENS];     // Primeira origem com o mesmo bonus (intercambiaveis)
+    int numAlvos;
+    int alvos[FINAL_MAX_ALVOS];
+    int bonusAlvo[FINAL_MAX_ALVOS];
+    int tropasAlvo[FINAL_MAX_ALVOS];
+    int faixaAlvo[FINAL_MAX_ALVOS];         // ceil(vida / danoPorTropa)
+    int grupoAlvo[FINAL_MAX_ALVOS];         // Primeiro alvo com o mesmo bonus (intercambiaveis)
+    int vencedoras[13];                     // [k + 6] = pares de dados com atacante - defensor > k
+} FinalDeJogo;
+
+// Estado do solucionador empacotado em duas palavras (ver chaveFinal())
+typedef struct {
+    unsigned long long baixa;               // 0 = slot vazio na tabela
+    unsigned long long alta;
+} ChaveFinal;
+
+// Tabela de memorizacao (enderecamento aberto) de uma thread do solucionador
+typedef struct {
+    ChaveFinal* chaves;
+    double* valores;
+    size_t capacidade;
+    size_t quantidade;
+    int esgotada;                           // Passou de FINAL_MAX_ESTADOS: resultado invalido
+} MemoFinal;
+
+// Primeiro ataque candidato e a chance de cumprir a missao depois dele
+typedef struct {
+    int origem;                             // Indice em FinalDeJogo.origens
+    int alvo;                               // Indice em FinalDeJogo.alvos
+    int tropas;
+    double chance;
+} AcaoFinal;
+
+// Ataques iniciais compartilhados pelas threads; cada thread pega o proximo livre
+typedef struct {
+    const FinalDeJogo* final;
+    AcaoFinal* acoes;
+    int numAcoes;
+    _Atomic int proxima;
+    _Atomic long estados;
+    _Atomic int esgotado;
+} TrabalhoFinal;
+
+// Gerador de inicios equilibrados, compartilhado pelas threads. O conjunto de hashes e uma
+// tabela de enderecamento aberto preenchida por CAS (0 = vazio); os registros aceitos sao
+// gravados com pwrite() em faixas do arquivo reservadas pelo contador 'reservados'.
+typedef struct {
+    int descritor;
+    long alvo;                      // Inicios a gravar
+    int equilibrio;                 // Diferenca maxima entre as cores, em % da forca media
+    atomic_ullong* hashes;
+    size_t capacidade;
+    _Atomic long reservados;
+    _Atomic long gerados;
+    _Atomic long duplicados;
+    _Atomic int falhou;
+    long maxGerados;
+    unsigned long long semente;
+    _Atomic int proximaThread;      // Numera as threads para sementes diferentes
+} TrabalhoInicios;
+
+// Opcoes recebidas pela linha de comando
+typedef struct {
+    const char* exportarBatalhas;
+    const char* exportarCsv;
+    const char* resumoBatalhas;
+    const char* varredura;
+    const char* transmitir;
+    const char* espectador;
+    const char* autojogo;
+    const char* politica;
+    const char* gerarInicios;
+    const char* inicio;
+    int indiceInicio;
+    int benchInfluencia;
+    int verificarFinal;
+    int inicios;
+    int equilibrio;
+    int threads;
+    int partidas;
+} OpcoesExecucao;
+
+// --- Tabelas Globais ---
+// Nomes dos territorios, na ordem do mapa.
+static const char* const NOMES_TERRITORIOS[NUM_TERRITORIOS] = {
+    "Brasil", "Argentina", "Peru", "Venezuela", "Uruguai", "Chile",
+    "Mexico", "Estados Unidos", "Canada", "Groenlandia", "Alasca", "Mackenzie",
+    "Franca", "Alemanha", "Inglaterra", "Suecia", "Polonia", "Espanha",
+    "Egito", "Argelia", "Sudao", "Congo", "Africa do Sul", "Madagascar",
+    "Oriente Medio", "Arabia", "India", "China", "Mongolia", "Japao",
+    "Vietna", "Coreia", "Siberia", "Tchita", "Ural", "Omsk",
+    "Australia", "Nova Guine", "Borneo", "Sumatra", "Nova Zelandia", "Filipinas"
+};
+
+// Cores dos exercitos, na mesma ordem usada em inicializarTerritorios().
+static const char* const NOMES_CORES[NUM_CORES] = {"Vermelho", "Verde", "Amarelo", "Preto", "Branco", "Rosa"};
+
+// Continentes, na ordem em que os territorios aparecem no mapa.
+static const Continente CONTINENTES[NUM_CONTINENTES] = {
+    {"AmericaDoSul", 0, 6},
+    {"AmericaDoNorte", 6, 6},
+    {"Europa", 12, 6},
+    {"Africa", 18, 6},
+    {"Asia", 24, 12},
+    {"Oceania", 36, 6}
+};
+
+// Missoes padrao, usadas quando o arquivo de missoes nao existe ou nao tem nenhuma missao valida.
+// Formato: <condicoes> | <descricao>
+static const char* const MISSOES_PADRAO[NUM_MISSOES] = {
+    "destroy Vermelho | Destruir completamente o exercito VERMELHO.",
+    "destroy Verde | Destruir completamente o exercito VERDE.",
+    "own 18 | Conquistar 18 territorios a sua escolha.",
+    "own 24 | Conquistar 24 territorios a sua escolha.",
+    "own continent AmericaDoSul and Africa | Conquistar a America do Sul e a Africa inteiras."
+};
+
+static CatalogoMissoes catalogoMissoes;
+
+enum { PLACAR_LIVRE = 0, PLACAR_RESERVANDO, PLACAR_PRONTO };
+static PlacarGlobal placarGlobal;
+static PersistenciaPlacar persistenciaPlacar;
+static _Thread_local int fragmentoDaThread = -1;    // Fragmento reservado (-1 = nenhum)
+static _Thread_local unsigned fragmentoCandidato; // Proximo fragmento a tentar enquanto nao ha reserva
+
+// Colunas do arquivo de batalhas, na ordem em que sao gravadas em cada bloco.
+#define COLUNA(campo) {#campo, sizeof(((ColunasBatalha*)0)->campo[0]), offsetof(ColunasBatalha, campo)}
+static const DescricaoColuna COLUNAS_BATALHA[] = {
+    COLUNA(poderAtacante), COLUNA(poderDefensor), COLUNA(tropasAtaque), COLUNA(tropasDefensor),
+    COLUNA(dadoAtacante), COLUNA(dadoDefensor), COLUNA(forcaAtacante), COLUNA(forcaDefensor),
+    COLUNA(dano), COLUNA(conquistou), COLUNA(turno)
+};
+#undef COLUNA
+#define NUM_COLUNAS_BATALHA ((int)(sizeof(COLUNAS_BATALHA) / sizeof(COLUNAS_BATALHA[0])))
+
+// Exportador ativo na thread atual; aplicarBatalha() e resolverBlitz() registram as batalhas nele.
+static _Thread_local ExportadorBatalhas* exportadorDaThread = NULL;
+
+// Transmissao ativa na thread atual; aplicarBatalha() e resolverBlitz() publicam cada batalha nela.
+static _Thread_local Transmissor* transmissorDaThread = NULL;
+
+// Distribuicoes de ataque relampago ja calculadas, por thread (mapeamento direto pela chave).
+static _Thread_local DistribuicaoBlitz cacheBlitz[BLITZ_CACHE];
+
+// Regras originais do jogo e regras usadas por resolverAtaque() na thread atual.
+static const ParametrosCombate REGRAS_PADRAO = {100, 10, 2};
+static _Thread_local const ParametrosCombate* regrasDaThread = &REGRAS_PADRAO;
+
+// Estado do gerador pseudoaleatorio da thread (xorshift64*); cada thread tem sua sequencia.
+static _Thread_local unsigned long long estadoAleatorio = 0x9E3779B97F4A7C15ULL;
+
+// Fronteiras do mapa padrao (pares de indices de territorios vizinhos).
+static const int FRONTEIRAS[][2] = {
+    {0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 19}, {1, 2}, {1, 4}, {1, 5}, {2, 3}, {2, 5}, {3, 6},
+    {6, 7}, {7, 8}, {7, 11}, {8, 9}, {8, 11}, {9, 11}, {9, 14}, {10, 11}, {10, 32},
+    {12, 13}, {12, 14}, {12, 17}, {12, 18}, {12, 19}, {13, 14}, {13, 16}, {14, 15}, {15, 16},
+    {16, 24}, {16, 34}, {17, 19},
+    {18, 19}, {18, 20}, {18, 24}, {19, 20}, {19, 21}, {20, 21}, {20, 22}, {20, 23}, {21, 22}, {22, 23},
+    {24, 25}, {24, 26}, {25, 26}, {26, 27}, {26, 30}, {26, 39}, {27, 28}, {27, 30}, {27, 31},
+    {27, 34}, {27, 35}, {28, 33}, {28, 35}, {29, 31}, {29, 32}, {30, 38}, {30, 41}, {31, 32},
+    {32, 33}, {33, 35}, {34, 35},
+    {36, 37}, {36, 38}, {36, 39}, {36, 40}, {37, 38}, {37, 41}, {38, 39}, {38, 41}
+};
+#define NUM_FRONTEIRAS ((int)(sizeof(FRONTEIRAS) / sizeof(FRONTEIRAS[0])))
+
+// Valores testados pela varredura, alem das alocacoes de vida de 0 a MAX_VIDA.
+static const int VARREDURA_DIVISORES_PODER[] = {50, 100, 200};
+static const int VARREDURA_DANOS_POR_TROPA[] = {5, 10, 20};
+static const int VARREDURA_DIVISORES_CONQUISTA[] = {2, 3};
+
 // --- Prototipos das Funcoes ---
 // Declaracoes antecipadas de todas as funcoes que serao usadas no programa, organizadas por categoria.
 
 // Funcoes de setup e gerenciamento de memoria:
 Territorio* alocarMapa(void);
 void inicializarTerritorios(Territorio* mapa, const Jogador* jogador);
+void aplicarPaisOrigem(Territorio* mapa, const Jogador* jogador);
 void liberarMemoria(Territorio* mapa);
 
 // Funcoes de configuracao do jogador:
@@ -83,7 +706,7 @@ void exibirStatusGeral(const Territorio* mapa, const Jogador* jogador);
 void atualizarPontuacao(Jogador* jogador, int tipoAcao, int valor);
 void exibirResultadoFinal(const Territorio* mapa, const Jogador* jogador, int vitoria);
 void exibirInimigosEAliados(const Territorio* mapa, const Jogador* jogador);
-void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador);
+void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador, const MapaInfluencia* influencia);
 
 // Funcoes de interface com o usuario:
 void exibirMenuPrincipal(void);
@@ -92,20 +715,185 @@ void exibirMapaComStatus(const Territorio* mapa, const Jogador* jogador);
 void exibirMissao(int idMissao);
 
 // Funcoes de logica principal do jogo:
-void faseDeAtaque(Territorio* mapa, Jogador* jogador);
-void simularAtaque(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador, int tropasAtaque);
+int faseDeAtaque(Territorio* mapa, Jogador* jogador, int alterados[2], PreCalculo* precalculo);
+int faseDeBlitz(Territorio* mapa, Jogador* jogador, int alterados[2], PreCalculo* precalculo);
+ResultadoBlitz resolverBlitz(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador,
+                             int tropasAtaque, int tropasMinimas, int maxRodadas);
+void liberarCacheBlitz(void);
+StatusAtaque simularAtaque(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador, int tropasAtaque);
+void exibirResultadoBatalha(const Territorio* territorioOrigem, const Territorio* territorioDestino,
+                            const Jogador* jogador, int tropasAtaque, const ResultadoBatalha* resultado);
+ResultadoBatalha resolverAtaque(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador, int tropasAtaque);
+StatusAtaque validarAtaque(const Territorio* territorioOrigem, const Territorio* territorioDestino, const Jogador* jogador);
 int sortearMissao(void);
 int verificarVitoria(const Territorio* mapa, int idMissao, const char* corJogador);
 
+// Funcoes do sistema de missoes:
+int carregarMissoes(const char* caminho);
+int compilarMissao(const char* linha, MissaoCompilada* missao);
+void extrairEstadoPosse(const Territorio* mapa, const char* corJogador, EstadoPosse* estado);
+int avaliarMissao(const MissaoCompilada* missao, const EstadoPosse* estado);
+int indiceCor(const char* cor);
+int indiceContinente(const char* nome);
+int continenteDoTerritorio(int indice);
+
+// Funcoes de estado copy-on-write e analise hipotetica:
+int estadoCriar(EstadoJogo* estado, const Territorio* mapa, const Jogador* jogador);
+void estadoSnapshot(const EstadoJogo* origem, EstadoJogo* copia);
+void estadoLiberar(EstadoJogo* estado);
+const Territorio* estadoLer(const EstadoJogo* estado, int indice);
+Territorio* estadoEscrever(EstadoJogo* estado, int indice);
+void estadoParaMapa(const EstadoJogo* estado, Territorio* mapa);
+ResultadoBatalha estadoSimularAtaque(EstadoJogo* estado, int origem, int destino, int tropasAtaque);
+void historicoIniciar(HistoricoEstados* historico, const EstadoJogo* inicial);
+void historicoRegistrar(HistoricoEstados* historico, const EstadoJogo* estado);
+int historicoDesfazer(HistoricoEstados* historico, EstadoJogo* estado);
+int historicoRefazer(HistoricoEstados* historico, EstadoJogo* estado);
+void historicoLiberar(HistoricoEstados* historico);
+void analiseHipotetica(const Territorio* mapa, const Jogador* jogador, PreCalculo* precalculo);
+
+// Funcoes do placar global:
+int placarRegistrarJogador(const char* nome);
+void placarSomar(int idPlacar, long pontos, long batalhasVencidas, long territoriosConquistados);
+void placarLiberarFragmento(void);
+int placarConsultar(PosicaoPlacar posicoes[], int maximo);
+int placarTopK(PosicaoPlacar posicoes[], int k);
+void exibirPlacarGlobal(const Jogador* jogador);
+int placarSalvar(const char* caminho);
+int placarCarregar(const char* caminho);
+int placarIniciarPersistencia(const char* caminho, int intervaloSegundos);
+void placarEncerrarPersistencia(void);
+
+// Funcoes de exportacao de batalhas:
+ExportadorBatalhas* exportadorAbrir(const char* caminhoBinario, const char* caminhoCsv);
+void exportadorAtivarNaThread(ExportadorBatalhas* exportador);
+void exportadorRegistrar(ExportadorBatalhas* exportador, const Territorio* territorioOrigem,
+                         const Territorio* territorioDestino, int tropasAtaque, const ResultadoBatalha* resultado);
+void exportadorRegistrarBlitz(ExportadorBatalhas* exportador, const Territorio* territorioOrigem,
+                              const Territorio* territorioDestino, int tropasAtaque,
+                              const char* ordem, int rodadas, int conquistou);
+int exportadorDescarregar(ExportadorBatalhas* exportador);
+int exportadorFechar(ExportadorBatalhas* exportador);
+int lerResumoBatalhas(const char* caminho, ResumoBatalhas* resumo);
+void exibirResumoBatalhas(const ResumoBatalhas* resumo);
+
+// Funcoes de simulacao e varredura de parametros:
+void semearAleatorio(unsigned long long semente);
+int sortearInt(int limite);
+void definirRegrasNaThread(const ParametrosCombate* regras);
+int alvoDaMissao(const MissaoCompilada* missao, const Territorio* territorio, int indice);
+int escolherAtaqueAutomatico(const Territorio* mapa, const Jogador* jogador, int idMissao,
+                             int* origem, int* destino, int* tropas);
+int jogarPartidaSimulada(int vidaJogador, int idMissao, int maxTurnos);
+int simularAteFim(Territorio* mapa, Jogador* jogador, int idMissao, int maxTurnos);
+int executarVarredura(const char* caminhoSaida, int numThreads, int partidas);
+
+// Funcoes do grafo de territorios e do mapa de influencia:
+int grafoCriar(GrafoTerritorios* grafo, int numTerritorios, const int (*arestas)[2], int numArestas);
+void grafoLiberar(GrafoTerritorios* grafo);
+int forcaTerritorio(const Territorio* territorio);
+int corInfluencia(const char* cor);
+int influenciaCriar(MapaInfluencia* mapaInfluencia, const GrafoTerritorios* grafo, const Territorio* mapa);
+void influenciaLiberar(MapaInfluencia* mapaInfluencia);
+void influenciaAtualizar(MapaInfluencia* mapaInfluencia, int territorio, int cor, int forca);
+void influenciaSincronizar(MapaInfluencia* mapaInfluencia, const Territorio* mapa, int territorio);
+double influenciaDaCor(const MapaInfluencia* mapaInfluencia, int territorio, int cor);
+double influenciaAmeaca(const MapaInfluencia* mapaInfluencia, int territorio);
+int executarBancadaInfluencia(int numTerritorios);
+
+// Funcoes do laco assincrono e pre-calculo em segundo plano:
+void precalculoIniciar(PreCalculo* precalculo, const Territorio* mapa, const Jogador* jogador, int idMissao);
+void precalculoReiniciar(PreCalculo* precalculo, const Territorio* mapa, const Jogador* jogador, int idMissao);
+void precalculoAguardar(PreCalculo* precalculo, int tarefas);
+void precalculoEncerrar(PreCalculo* precalculo);
+double chanceVitoriaBatalha(const Territorio* origem, const Territorio* destino, int tropasAtaque);
+void exibirPreCalculo(PreCalculo* precalculo);
+int lerLinhaAssincrona(PreCalculo* precalculo, const char* formato, ...);
+int lerInteiroAssincrono(PreCalculo* precalculo, const char* formato, ...);
+int lerOpcaoAssincrona(PreCalculo* precalculo);
+
+// Funcoes da transmissao para espectadores:
+Transmissor* transmissorAbrir(const char* nome, const Territorio* mapa, const Jogador* jogador);
+void transmissorAtivarNaThread(Transmissor* transmissor);
+void transmissorPublicar(Transmissor* transmissor, const Territorio* territorioOrigem,
+                         const Territorio* territorioDestino, const Jogador* jogador);
+void transmissorFechar(Transmissor* transmissor);
+int executarEspectador(const char* nome);
+
+// Funcoes do gerador de dados de autojogo:
+int escolherAtaqueAleatorio(const Territorio* mapa, const Jogador* jogador, int* origem, int* destino, int* tropas);
+int executarAutojogo(const char* prefixo, const char* politica, int numThreads, int partidas);
+
+// Funcoes do solucionador exato de final de jogo:
+int prepararFinalDeJogo(const Territorio* mapa, const Jogador* jogador, int idMissao, FinalDeJogo* final);
+int resolverFinalDeJogo(const FinalDeJogo* final, int numThreads, AcaoFinal* melhor, long* estados);
+double verificarFinalDeJogo(const Territorio* mapa, const Jogador* jogador, int idMissao,
+                            const FinalDeJogo* final, int partidas);
+void analisarFinalDeJogo(const Territorio* mapa, const Jogador* jogador, int idMissao, int numThreads,
+                         int partidasVerificacao);
+
+// Funcoes do gerador de inicios equilibrados:
+int equilibrioDoMapa(const Territorio* mapa);
+int executarGeracaoInicios(const char* caminho, long quantidade, int equilibrio, int numThreads);
+int carregarInicio(const char* caminho, long indice, Territorio* mapa, int* equilibrio);
+
+// Funcoes de linha de comando:
+int lerOpcoesExecucao(int argc, char* argv[], OpcoesExecucao* opcoes);
+
 // Funcao utilitaria:
 void limparBufferEntrada(void);
 
 // --- Funcao Principal (main) ---
 // Funcao principal que orquestra o fluxo do jogo, chamando as outras funcoes em ordem.
-int main() {
+int main(int argc, char* argv[]) {
     // 1. Configuracao Inicial (Setup):
+    OpcoesExecucao opcoes;
+    if (!lerOpcoesExecucao(argc, argv, &opcoes)) {
+        return 1;
+    }
+    
+    // Modo de leitura: apenas resume um arquivo de batalhas exportado
+    if (opcoes.resumoBatalhas != NULL) {
+        ResumoBatalhas resumo;
+        if (!lerResumoBatalhas(opcoes.resumoBatalhas, &resumo)) {
+            printf("Erro: Nao foi possivel ler o arquivo de batalhas %s!\n", opcoes.resumoBatalhas);
+            return 1;
+        }
+        exibirResumoBatalhas(&resumo);
+        return 0;
+    }
+    
+    // Modo de medicao: confere e cronometra o mapa de influencia em um mapa gerado
+    if (opcoes.benchInfluencia > 0) {
+        return executarBancadaInfluencia(opcoes.benchInfluencia) ? 0 : 1;
+    }
+    
+    // Modo espectador: acompanha um jogo transmitido por outro processo
+    if (opcoes.espectador != NULL) {
+        return executarEspectador(opcoes.espectador) ? 0 : 1;
+    }
+    
     // Removido setlocale para evitar problemas com caracteres especiais
-    srand((unsigned int)time(NULL));
+    semearAleatorio((unsigned long long)time(NULL));
+    carregarMissoes("missoes.txt");
+    
+    // Modo de varredura: simula grades de parametros e sai
+    if (opcoes.varredura != NULL) {
+        return executarVarredura(opcoes.varredura, opcoes.threads, opcoes.partidas) ? 0 : 1;
+    }
+    
+    // Modo de autojogo: gera dados de treino com partidas automaticas e sai
+    if (opcoes.autojogo != NULL) {
+        return executarAutojogo(opcoes.autojogo, opcoes.politica, opcoes.threads, opcoes.partidas) ? 0 : 1;
+    }
+    
+    // Modo gerador: grava inicios equilibrados em um arquivo e sai
+    if (opcoes.gerarInicios != NULL) {
+        return executarGeracaoInicios(opcoes.gerarInicios, opcoes.inicios, opcoes.equilibrio, opcoes.threads) ? 0 : 1;
+    }
+    
+    placarCarregar("placar.txt");
+    placarIniciarPersistencia("placar.txt", PLACAR_INTERVALO_SALVAR);
     
     Territorio* mapa = alocarMapa();
     if (mapa == NULL) {
@@ -113,37 +901,112 @@ int main() {
         return 1;
     }
     
+    // Inicio gravado pelo gerador de inicios, ou sorteio temporario para permitir a configuracao
+    int equilibrioInicio = 0;
+    if (opcoes.inicio != NULL) {
+        if (!carregarInicio(opcoes.inicio, opcoes.indiceInicio, mapa, &equilibrioInicio)) {
+            printf("Erro: Nao foi possivel ler o inicio %d de %s!\n", opcoes.indiceInicio, opcoes.inicio);
+            liberarMemoria(mapa);
+            return 1;
+        }
+    } else {
+        inicializarTerritorios(mapa, NULL);
+    }
+    
+    ExportadorBatalhas* exportador = NULL;
+    if (opcoes.exportarBatalhas != NULL) {
+        exportador = exportadorAbrir(opcoes.exportarBatalhas, opcoes.exportarCsv);
+        if (exportador == NULL) {
+            printf("Erro: Nao foi possivel criar o arquivo de batalhas %s!\n", opcoes.exportarBatalhas);
+            liberarMemoria(mapa);
+            return 1;
+        }
+        exportadorAtivarNaThread(exportador);
+    }
+    
     // Configuracao do jogador
     Jogador jogador = {0}; // Inicializa com zeros
     printf("=== BEM-VINDO AO WAR ESTRUTURADO ===\n\n");
     
-    // Inicializacao temporaria para permitir configuracao
-    inicializarTerritorios(mapa, NULL);
     configurarJogador(&jogador, mapa);
     
-    // Reinicializa com dados do jogador
-    inicializarTerritorios(mapa, &jogador);
+    // Reinicializa com dados do jogador (num inicio carregado, so o pais de origem muda)
+    if (opcoes.inicio != NULL) {
+        aplicarPaisOrigem(mapa, &jogador);
+        
+        // O pais de origem nao faz parte do registro gerado; confere se o mapa continua equilibrado
+        int diferenca = equilibrioDoMapa(mapa);
+        if (diferenca == INT_MAX) {
+            printf("\nAviso: Com o seu pais de origem alguma cor ficou sem territorios; o inicio gravado\n"
+                   "deixou de ser equilibrado. Escolha outra cor ou outro pais para uma partida equilibrada.\n");
+        } else if (diferenca > equilibrioInicio) {
+            printf("\nAviso: Com o seu pais de origem a diferenca de forca entre as cores ficou em %d%%,\n"
+                   "acima dos %d%% do inicio gravado. Escolha outra cor ou outro pais para uma partida equilibrada.\n", diferenca, equilibrioInicio);
+        }
+    } else {
+        inicializarTerritorios(mapa, &jogador);
+    }
+    jogador.idPlacar = placarRegistrarJogador(jogador.nome);
+    
+    Transmissor* transmissor = NULL;
+    if (opcoes.transmitir != NULL) {
+        transmissor = transmissorAbrir(opcoes.transmitir, mapa, &jogador);
+        if (transmissor == NULL) {
+            printf("Aviso: Nao foi possivel abrir a transmissao %s; jogando sem espectadores.\n", opcoes.transmitir);
+        }
+        transmissorAtivarNaThread(transmissor);
+    }
+    
+    // Mapa de influencia sobre as fronteiras do mapa padrao, atualizado a cada ataque
+    GrafoTerritorios grafo;
+    MapaInfluencia influencia;
+    if (!grafoCriar(&grafo, NUM_TERRITORIOS, FRONTEIRAS, NUM_FRONTEIRAS)) {
+        printf("Erro: Nao foi possivel alocar memoria para o mapa de influencia!\n");
+        liberarMemoria(mapa);
+        return 1;
+    }
+    if (!influenciaCriar(&influencia, &grafo, mapa)) {
+        printf("Erro: Nao foi possivel alocar memoria para o mapa de influencia!\n");
+        grafoLiberar(&grafo);
+        liberarMemoria(mapa);
+        return 1;
+    }
     
     int missaoJogador = sortearMissao();
     int opcao;
     int jogoAtivo = 1;
+    int turno = 0;
     
     printf("\nSua missao foi sorteada!\n\n");
     
+    // Analises de segundo plano: recalculadas sempre que o mapa muda, enquanto o jogador pensa
+    PreCalculo precalculo;
+    precalculoIniciar(&precalculo, mapa, &jogador, missaoJogador);
+    
     // 2. Laco Principal do Jogo (Game Loop):
     do {
         exibirStatusGeral(mapa, &jogador);
         exibirMissao(missaoJogador);
         exibirMenuPrincipal();
         
-        printf("Escolha uma opcao: ");
-        scanf("%d", &opcao);
-        limparBufferEntrada();
+        opcao = lerOpcaoAssincrona(&precalculo);
         
         switch (opcao) {
             case 1:
                 // Opcao 1: Inicia a fase de ataque.
-                faseDeAtaque(mapa, &jogador);
+                turno++;
+                if (exportador != NULL) exportador->turnoAtual = turno;
+                if (transmissor != NULL) transmissor->turnoAtual = turno;
+                {
+                    int alterados[2];
+                    int numAlterados = faseDeAtaque(mapa, &jogador, alterados, &precalculo);
+                    for (int i = 0; i < numAlterados; i++) {
+                        influenciaSincronizar(&influencia, mapa, alterados[i]);
+                    }
+                    if (numAlterados > 0) {
+                        precalculoReiniciar(&precalculo, mapa, &jogador, missaoJogador);
+                    }
+                }
                 break;
                 
             case 2:
@@ -158,17 +1021,43 @@ int main() {
                 break;
                 
             case 3:
-                // Opcao 3: Exibir ranking e estatisticas detalhadas
+                // Opcao 3: Exibir ranking e estatisticas detalhadas (ja calculadas em segundo plano)
+                precalculoAguardar(&precalculo, PRECALCULO_ESTATISTICAS);
+                exibirRanking(precalculo.estatisticas, &jogador);
+                exibirPlacarGlobal(&jogador);
+                break;
+                
+            case 4:
+                // Opcao 4: Analisar inimigos e aliados, com as previsoes de segundo plano
+                analisarRelacoesDiplomaticas(mapa, &jogador, &influencia);
+                exibirPreCalculo(&precalculo);
+                break;
+                
+            case 5:
+                // Opcao 5: Simula ataques sobre uma copia do mapa, sem alterar o jogo real
+                analiseHipotetica(mapa, &jogador, &precalculo);
+                break;
+                
+            case 6:
+                // Opcao 6: Repete o ataque ate conquistar ou atingir a condicao de parada, de uma vez
+                turno++;
+                if (exportador != NULL) exportador->turnoAtual = turno;
+                if (transmissor != NULL) transmissor->turnoAtual = turno;
                 {
-                    EstatisticaExercito estatisticas[NUM_CORES];
-                    calcularEstatisticas(mapa, estatisticas);
-                    exibirRanking(estatisticas, &jogador);
+                    int alterados[2];
+                    int numAlterados = faseDeBlitz(mapa, &jogador, alterados, &precalculo);
+                    for (int i = 0; i < numAlterados; i++) {
+                        influenciaSincronizar(&influencia, mapa, alterados[i]);
+                    }
+                    if (numAlterados > 0) {
+                        precalculoReiniciar(&precalculo, mapa, &jogador, missaoJogador);
+                    }
                 }
                 break;
                 
-            case 4:
-                // Opcao 4: Analisar inimigos e aliados
-                analisarRelacoesDiplomaticas(mapa, &jogador);
+            case 7:
+                // Opcao 7: Chance exata de cumprir a missao e melhor ataque, quando faltam poucos alvos
+                analisarFinalDeJogo(mapa, &jogador, missaoJogador, opcoes.threads, opcoes.verificarFinal);
                 break;
                 
             case 0:
@@ -184,14 +1073,27 @@ int main() {
         }
         
         if (jogoAtivo) {
-            printf("\nPressione Enter para continuar...");
-            getchar();
+            lerLinhaAssincrona(&precalculo, "\nPressione Enter para continuar...");
             system("cls"); // Para Windows, use "clear" para Linux/Mac
         }
         
     } while (jogoAtivo);
     
     // 3. Limpeza:
+    precalculoEncerrar(&precalculo);
+    liberarCacheBlitz();
+    placarLiberarFragmento();
+    placarEncerrarPersistencia();
+    transmissorAtivarNaThread(NULL);
+    transmissorFechar(transmissor);
+    if (exportador != NULL) {
+        exportadorAtivarNaThread(NULL);
+        if (!exportadorFechar(exportador)) {
+            printf("Erro ao gravar o arquivo de batalhas!\n");
+        }
+    }
+    influenciaLiberar(&influencia);
+    grafoLiberar(&grafo);
     liberarMemoria(mapa);
     return 0;
 }
@@ -209,17 +1111,7 @@ Territorio* alocarMapa(void) {
 // Preenche os dados iniciais de cada territorio no mapa (nome, cor do exercito, numero de tropas).
 // Esta funcao modifica o mapa passado por referencia (ponteiro).
 void inicializarTerritorios(Territorio* mapa, const Jogador* jogador) {
-    const char* nomes[NUM_TERRITORIOS] = {
-        "Brasil", "Argentina", "Peru", "Venezuela", "Uruguai", "Chile",
-        "Mexico", "Estados Unidos", "Canada", "Groenlandia", "Alasca", "Mackenzie",
-        "Franca", "Alemanha", "Inglaterra", "Suecia", "Polonia", "Espanha",
-        "Egito", "Argelia", "Sudao", "Congo", "Africa do Sul", "Madagascar",
-        "Oriente Medio", "Arabia", "India", "China", "Mongolia", "Japao",
-        "Vietna", "Coreia", "Siberia", "Tchita", "Ural", "Omsk",
-        "Australia", "Nova Guine", "Borneo", "Sumatra", "Nova Zelandia", "Filipinas"
-    };
-    
-    const char* cores[NUM_CORES] = {"Vermelho", "Verde", "Amarelo", "Preto", "Branco", "Rosa"};
+    const char* const* nomes = NOMES_TERRITORIOS;
     
     for (int i = 0; i < NUM_TERRITORIOS; i++) {
         strcpy(mapa[i].nome, nomes[i]);
@@ -231,10 +1123,23 @@ void inicializarTerritorios(Territorio* mapa, const Jogador* jogador) {
             mapa[i].poder = jogador->poder;
             mapa[i].numTropas = 10; // Pais de origem comeca com mais tropas
         } else {
-            strcpy(mapa[i].corExercito, cores[rand() % NUM_CORES]);
-            mapa[i].vida = rand() % 301 + 200; // 200 a 500 de vida
-            mapa[i].poder = rand() % 301 + 200; // 200 a 500 de poder
-            mapa[i].numTropas = rand() % 5 + 1; // 1 a 5 tropas
+            strcpy(mapa[i].corExercito, NOMES_CORES[sortearInt(NUM_CORES)]);
+            mapa[i].vida = sortearInt(301) + 200; // 200 a 500 de vida
+            mapa[i].poder = sortearInt(301) + 200; // 200 a 500 de poder
+            mapa[i].numTropas = sortearInt(5) + 1; // 1 a 5 tropas
+        }
+    }
+}
+
+// aplicarPaisOrigem():
+// Entrega o pais de origem ao jogador, como inicializarTerritorios() faz, sem sortear o resto do mapa.
+void aplicarPaisOrigem(Territorio* mapa, const Jogador* jogador) {
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (strcmp(mapa[i].nome, jogador->paisOrigem) == 0) {
+            strcpy(mapa[i].corExercito, jogador->cor);
+            mapa[i].vida = jogador->vida;
+            mapa[i].poder = jogador->poder;
+            mapa[i].numTropas = 10; // Pais de origem comeca com mais tropas
         }
     }
 }
@@ -264,9 +1169,8 @@ void configurarJogador(Jogador* jogador, const Territorio* mapa) {
     scanf("%d", &escolhaCor);
     limparBufferEntrada();
     
-    const char* cores[NUM_CORES] = {"Vermelho", "Verde", "Amarelo", "Preto", "Branco", "Rosa"};
     if (escolhaCor >= 1 && escolhaCor <= NUM_CORES) {
-        strcpy(jogador->cor, cores[escolhaCor - 1]);
+        strcpy(jogador->cor, NOMES_CORES[escolhaCor - 1]);
     } else {
         strcpy(jogador->cor, "Azul"); // Cor padrao
     }
@@ -350,6 +1254,9 @@ void exibirMenuPrincipal(void) {
     printf("2. Verificar vitoria\n");
     printf("3. Ver ranking e estatisticas\n");
     printf("4. Analisar inimigos e aliados\n");
+    printf("5. Analise hipotetica (e se?)\n");
+    printf("6. Ataque relampago (ate conquistar)\n");
+    printf("7. Resolver final de jogo (chance exata)\n");
     printf("0. Sair do jogo\n");
     printf("=====================\n");
 }
@@ -380,25 +1287,10 @@ void exibirMapa(const Territorio* mapa) {
 void exibirMissao(int idMissao) {
     printf("\n=== SUA MISSAO ===\n");
     
-    switch (idMissao) {
-        case 1:
-            printf("Destruir completamente o exercito VERMELHO.\n");
-            break;
-        case 2:
-            printf("Destruir completamente o exercito VERDE.\n");
-            break;
-        case 3:
-            printf("Conquistar 18 territorios a sua escolha.\n");
-            break;
-        case 4:
-            printf("Conquistar 24 territorios a sua escolha.\n");
-            break;
-        case 5:
-            printf("Conquistar a America do Sul e a Africa inteiras.\n");
-            break;
-        default:
-            printf("Missao desconhecida.\n");
-            break;
+    if (idMissao >= 1 && idMissao <= catalogoMissoes.quantidade) {
+        printf("%s\n", catalogoMissoes.missoes[idMissao - 1].descricao);
+    } else {
+        printf("Missao desconhecida.\n");
     }
     printf("==================\n");
 }
@@ -406,27 +1298,24 @@ void exibirMissao(int idMissao) {
 // faseDeAtaque():
 // Gerencia a interface para a acao de ataque, solicitando ao jogador os territorios de origem e destino.
 // Chama a funcao simularAtaque() para executar a logica da batalha.
-void faseDeAtaque(Territorio* mapa, Jogador* jogador) {
+// As respostas sao lidas por lerInteiroAssincrono(), que segue exibindo as analises de segundo plano.
+// Preenche 'alterados' com os indices dos territorios envolvidos e retorna quantos sao (0 se nao houve ataque).
+int faseDeAtaque(Territorio* mapa, Jogador* jogador, int alterados[2], PreCalculo* precalculo) {
     int origem, destino, tropasBatalha;
     
     printf("\n=== FASE DE ATAQUE ===\n");
-    printf("Digite o ID do territorio de origem (1-%d): ", NUM_TERRITORIOS);
-    scanf("%d", &origem);
-    
-    printf("Digite o ID do territorio de destino (1-%d): ", NUM_TERRITORIOS);
-    scanf("%d", &destino);
+    origem = lerInteiroAssincrono(precalculo, "Digite o ID do territorio de origem (1-%d): ", NUM_TERRITORIOS);
+    destino = lerInteiroAssincrono(precalculo, "Digite o ID do territorio de destino (1-%d): ", NUM_TERRITORIOS);
     
     // Validacao basica dos IDs
     if (origem < 1 || origem > NUM_TERRITORIOS || destino < 1 || destino > NUM_TERRITORIOS) {
         printf("IDs de territorios invalidos!\n");
-        limparBufferEntrada();
-        return;
+        return 0;
     }
     
     if (origem == destino) {
         printf("Nao e possivel atacar o proprio territorio!\n");
-        limparBufferEntrada();
-        return;
+        return 0;
     }
     
     // Converte para indices do array (base 0)
@@ -436,75 +1325,174 @@ void faseDeAtaque(Territorio* mapa, Jogador* jogador) {
     // Verificacao se o territorio de origem pertence ao jogador
     if (strcmp(mapa[origem].corExercito, jogador->cor) != 0) {
         printf("Voce nao pode atacar com um territorio que nao e seu!\n");
-        limparBufferEntrada();
-        return;
+        return 0;
     }
     
     // Solicita numero de tropas para a batalha
-    printf("Digite quantas tropas usar no ataque (1-%d): ", MAX_TROPAS_ATAQUE);
-    scanf("%d", &tropasBatalha);
-    limparBufferEntrada();
+    tropasBatalha = lerInteiroAssincrono(precalculo, "Digite quantas tropas usar no ataque (1-%d): ", MAX_TROPAS_ATAQUE);
     
     if (tropasBatalha < 1 || tropasBatalha > MAX_TROPAS_ATAQUE) {
         printf("Numero de tropas invalido!\n");
-        return;
+        return 0;
     }
     
     printf("\nAtacando %s com %s usando %d tropas...\n", 
            mapa[destino].nome, mapa[origem].nome, tropasBatalha);
-    simularAtaque(&mapa[origem], &mapa[destino], jogador, tropasBatalha);
+    if (simularAtaque(&mapa[origem], &mapa[destino], jogador, tropasBatalha) != ATAQUE_REALIZADO) {
+        return 0; // Ataque recusado: nada mudou
+    }
+    
+    alterados[0] = origem;
+    alterados[1] = destino;
+    return 2;
+}
+
+// faseDeBlitz():
+// Interface do ataque relampago: pede origem, destino, tropas e a condicao de parada,
+// resolve todas as batalhas com resolverBlitz() e exibe o resumo.
+// Preenche 'alterados' como faseDeAtaque() e retorna quantos territorios mudaram.
+int faseDeBlitz(Territorio* mapa, Jogador* jogador, int alterados[2], PreCalculo* precalculo) {
+    int origem, destino, tropasBatalha, tropasMinimas;
+    
+    printf("\n=== ATAQUE RELAMPAGO ===\n");
+    origem = lerInteiroAssincrono(precalculo, "Digite o ID do territorio de origem (1-%d): ", NUM_TERRITORIOS);
+    destino = lerInteiroAssincrono(precalculo, "Digite o ID do territorio de destino (1-%d): ", NUM_TERRITORIOS);
+    tropasBatalha = lerInteiroAssincrono(precalculo, "Digite quantas tropas usar em cada ataque (1-%d): ", MAX_TROPAS_ATAQUE);
+    tropasMinimas = lerInteiroAssincrono(precalculo, "Parar quando a origem ficar com quantas tropas? (1 = ate o fim): ");
+    
+    if (origem < 1 || origem > NUM_TERRITORIOS || destino < 1 || destino > NUM_TERRITORIOS) {
+        printf("IDs de territorios invalidos!\n");
+        return 0;
+    }
+    if (origem == destino) {
+        printf("Nao e possivel atacar o proprio territorio!\n");
+        return 0;
+    }
+    origem--;
+    destino--;
+    if (strcmp(mapa[origem].corExercito, jogador->cor) != 0) {
+        printf("Voce nao pode atacar com um territorio que nao e seu!\n");
+        return 0;
+    }
+    if (tropasBatalha < 1 || tropasBatalha > MAX_TROPAS_ATAQUE) {
+        printf("Numero de tropas invalido!\n");
+        return 0;
+    }
+    
+    ResultadoBlitz resultado = resolverBlitz(&mapa[origem], &mapa[destino], jogador, tropasBatalha, tropasMinimas, 0);
+    if (resultado.status == ATAQUE_TROPAS_INSUFICIENTES) {
+        printf("Voce precisa de mais tropas na origem para atacar!\n");
+        return 0;
+    }
+    if (resultado.status == ATAQUE_TERRITORIO_PROPRIO) {
+        printf("Voce nao pode atacar seu proprio territorio!\n");
+        return 0;
+    }
+    if (resultado.status == ATAQUE_SEM_MEMORIA) {
+        printf("Erro: Nao foi possivel alocar memoria para o ataque relampago!\n");
+        return 0;
+    }
+    
+    printf("\n%d batalhas: %d vitorias e %d derrotas.\n", resultado.rodadas, resultado.vitorias, resultado.derrotas);
+    if (resultado.conquistou) {
+        printf("*** TERRITORIO CONQUISTADO! ***\n");
+        printf("%s agora pertence ao exercito %s!\n", mapa[destino].nome, jogador->cor);
+    } else {
+        printf("Ataque interrompido: %s ficou com %d tropas; %s ainda tem %d de vida.\n",
+               mapa[origem].nome, mapa[origem].numTropas, mapa[destino].nome, mapa[destino].vida);
+    }
+    
+    alterados[0] = origem;
+    alterados[1] = destino;
+    return 2;
 }
 
 // simularAtaque():
-// Executa a logica de uma batalha entre dois territorios.
-// Realiza validacoes, rola os dados, compara os resultados e atualiza o numero de tropas.
-// Se um territorio for conquistado, atualiza seu dono e move uma tropa.
-void simularAtaque(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador, int tropasAtaque) {
-    // Validacoes
-    if (territorioOrigem->numTropas <= 1) {
+// Executa a logica de uma batalha entre dois territorios por meio de resolverAtaque()
+// e exibe as validacoes, os resultados e eventuais conquistas.
+// Retorna o status do ataque (ATAQUE_REALIZADO se a batalha aconteceu).
+StatusAtaque simularAtaque(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador, int tropasAtaque) {
+    ResultadoBatalha resultado = resolverAtaque(territorioOrigem, territorioDestino, jogador, tropasAtaque);
+    exibirResultadoBatalha(territorioOrigem, territorioDestino, jogador, tropasAtaque, &resultado);
+    return resultado.status;
+}
+
+// exibirResultadoBatalha():
+// Mostra o desfecho de um ataque ja resolvido: a mensagem de recusa, ou as forcas,
+// o vencedor e a eventual conquista.
+void exibirResultadoBatalha(const Territorio* territorioOrigem, const Territorio* territorioDestino,
+                            const Jogador* jogador, int tropasAtaque, const ResultadoBatalha* resultado) {
+    if (resultado->status == ATAQUE_TROPAS_INSUFICIENTES) {
         printf("Voce precisa de pelo menos 2 tropas para atacar!\n");
         return;
     }
     
-    if (strcmp(territorioDestino->corExercito, jogador->cor) == 0) {
+    if (resultado->status == ATAQUE_TERRITORIO_PROPRIO) {
         printf("Voce nao pode atacar seu proprio territorio!\n");
         return;
     }
     
-    // Simulacao da batalha considerando vida, poder e tropas
-    int forcaAtacante = (rand() % 6 + 1) + (territorioOrigem->poder / 100) + tropasAtaque;
-    int forcaDefensor = (rand() % 6 + 1) + (territorioDestino->poder / 100) + territorioDestino->numTropas;
+    if (resultado->status == ATAQUE_SEM_MEMORIA) {
+        printf("Erro: Nao foi possivel alocar memoria para a batalha!\n");
+        return;
+    }
     
     printf("\nResultados da batalha:\n");
-    printf("Atacante (%s): Forca %d (Dados + Poder + Tropas)\n", territorioOrigem->nome, forcaAtacante);
-    printf("Defensor (%s): Forca %d (Dados + Poder + Tropas)\n", territorioDestino->nome, forcaDefensor);
+    printf("Atacante (%s): Forca %d (Dados + Poder + Tropas)\n", territorioOrigem->nome, resultado->forcaAtacante);
+    printf("Defensor (%s): Forca %d (Dados + Poder + Tropas)\n", territorioDestino->nome, resultado->forcaDefensor);
+    
+    if (resultado->atacanteVenceu) {
+        printf("Atacante venceu! %s perdeu %d de vida e 1 tropa.\n", territorioDestino->nome, resultado->dano);
+        
+        if (resultado->conquistou) {
+            printf("*** TERRITORIO CONQUISTADO! ***\n");
+            printf("%s agora pertence ao exercito %s!\n", territorioDestino->nome, jogador->cor);
+        }
+    } else {
+        printf("Defensor venceu! %s perdeu %d tropas.\n", territorioOrigem->nome, tropasAtaque);
+    }
+}
+
+// validarAtaque():
+// Confere se o ataque pode acontecer: a origem precisa de pelo menos 2 tropas e o destino
+// nao pode ser do proprio jogador. Nao altera nada.
+StatusAtaque validarAtaque(const Territorio* territorioOrigem, const Territorio* territorioDestino, const Jogador* jogador) {
+    if (territorioOrigem->numTropas <= 1) {
+        return ATAQUE_TROPAS_INSUFICIENTES;
+    }
+    if (strcmp(territorioDestino->corExercito, jogador->cor) == 0) {
+        return ATAQUE_TERRITORIO_PROPRIO;
+    }
+    return ATAQUE_REALIZADO;
+}
+
+// aplicarDesfecho():
+// Atualiza territorios e jogador com o desfecho ja decidido de uma batalha (atacanteVenceu,
+// dano e conquistou). Usada por aplicarBatalha() e pelas rodadas transmitidas de resolverBlitz().
+static void aplicarDesfecho(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador,
+                            int tropasAtaque, const ResultadoBatalha* resultado) {
+    const ParametrosCombate* regras = regrasDaThread;
     
-    if (forcaAtacante > forcaDefensor) {
+    if (resultado->atacanteVenceu) {
         // Atacante vence
-        int dano = tropasAtaque * 10; // Dano baseado nas tropas usadas
-        territorioDestino->vida -= dano;
+        territorioDestino->vida -= resultado->dano;
         territorioDestino->numTropas = (territorioDestino->numTropas > 1) ? territorioDestino->numTropas - 1 : 1;
         
-        printf("Atacante venceu! %s perdeu %d de vida e 1 tropa.\n", territorioDestino->nome, dano);
-        
         // Atualiza estatisticas do jogador
         jogador->batalhasVencidas++;
         atualizarPontuacao(jogador, 1, 10); // 10 pontos por vitoria
         
-        if (territorioDestino->vida <= 0) {
+        if (resultado->conquistou) {
             // Territorio conquistado
             strcpy(territorioDestino->corExercito, jogador->cor);
-            territorioDestino->vida = territorioOrigem->vida / 2; // Metade da vida do atacante
-            territorioDestino->poder = territorioOrigem->poder / 2; // Metade do poder do atacante
+            territorioDestino->vida = territorioOrigem->vida / regras->divisorConquista; // Fracao da vida do atacante (metade nas regras padrao)
+            territorioDestino->poder = territorioOrigem->poder / regras->divisorConquista; // Fracao do poder do atacante (metade nas regras padrao)
             territorioDestino->numTropas = tropasAtaque;
             territorioOrigem->numTropas -= tropasAtaque;
             
             // Atualiza estatisticas
             jogador->territoriosConquistados++;
             atualizarPontuacao(jogador, 2, 50); // 50 pontos por conquista
-            
-            printf("*** TERRITORIO CONQUISTADO! ***\n");
-            printf("%s agora pertence ao exercito %s!\n", territorioDestino->nome, jogador->cor);
         }
     } else {
         // Defensor vence
@@ -514,64 +1502,333 @@ void simularAtaque(Territorio* territorioOrigem, Territorio* territorioDestino,
         // Atualiza estatisticas do jogador
         jogador->batalhasPerdidas++;
         atualizarPontuacao(jogador, 3, -5); // -5 pontos por derrota
-        
-        printf("Defensor venceu! %s perdeu %d tropas.\n", territorioOrigem->nome, tropasAtaque);
     }
 }
 
-// sortearMissao():
-// Sorteia e retorna um ID de missao aleatorio para o jogador.
-int sortearMissao(void) {
-    return rand() % NUM_MISSOES + 1;
-}
+// aplicarBatalha():
+// Decide a batalha com os dados ja preenchidos em 'resultado', registra no exportador da thread,
+// atualiza territorios e jogador e publica a batalha na transmissao da thread. Usada por resolverAtaque().
+static void aplicarBatalha(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador,
+                           int tropasAtaque, ResultadoBatalha* resultado) {
+    // Simulacao da batalha considerando vida, poder e tropas
+    const ParametrosCombate* regras = regrasDaThread;
+    resultado->forcaAtacante = resultado->dadoAtacante + (territorioOrigem->poder / regras->divisorPoder) + tropasAtaque;
+    resultado->forcaDefensor = resultado->dadoDefensor + (territorioDestino->poder / regras->divisorPoder) + territorioDestino->numTropas;
+    
+    // Desfecho decidido uma unica vez, antes de alterar os territorios
+    resultado->atacanteVenceu = resultado->forcaAtacante > resultado->forcaDefensor;
+    resultado->dano = resultado->atacanteVenceu ? tropasAtaque * regras->danoPorTropa : 0; // Dano baseado nas tropas usadas
+    resultado->conquistou = resultado->atacanteVenceu && territorioDestino->vida - resultado->dano <= 0;
+    
+    if (exportadorDaThread != NULL) {
+        // Registrado com os valores que decidiram a batalha
+        exportadorRegistrar(exportadorDaThread, territorioOrigem, territorioDestino, tropasAtaque, resultado);
+    }
+    aplicarDesfecho(territorioOrigem, territorioDestino, jogador, tropasAtaque, resultado);
+    if (transmissorDaThread != NULL) {
+        transmissorPublicar(transmissorDaThread, territorioOrigem, territorioDestino, jogador);
+    }
+}
+
+// resolverAtaque():
+// Regras da batalha sem nenhuma saida na tela, para uso pelo jogo e pelas simulacoes.
+// Realiza validacoes, rola os dados, compara os resultados e atualiza territorios e jogador.
+// Se um territorio for conquistado, atualiza seu dono e move as tropas do ataque.
+ResultadoBatalha resolverAtaque(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador, int tropasAtaque) {
+    ResultadoBatalha resultado = {0};
+    
+    // Validacoes
+    resultado.status = validarAtaque(territorioOrigem, territorioDestino, jogador);
+    if (resultado.status != ATAQUE_REALIZADO) {
+        return resultado;
+    }
+    
+    resultado.dadoAtacante = sortearInt(6) + 1;
+    resultado.dadoDefensor = sortearInt(6) + 1;
+    aplicarBatalha(territorioOrigem, territorioDestino, jogador, tropasAtaque, &resultado);
+    return resultado;
+}
+
+// sortearMissao():
+// Sorteia e retorna um ID de missao aleatorio do catalogo carregado.
+int sortearMissao(void) {
+    return sortearInt(catalogoMissoes.quantidade) + 1;
+}
 
 // verificarVitoria():
 // Verifica se o jogador cumpriu os requisitos de sua missao atual.
-// Implementa a logica para cada tipo de missao (destruir um exercito ou conquistar um numero de territorios).
+// Extrai o estado de posse do mapa e executa o bytecode da missao sobre ele.
 // Retorna 1 (verdadeiro) se a missao foi cumprida, e 0 (falso) caso contrario.
 int verificarVitoria(const Territorio* mapa, int idMissao, const char* corJogador) {
-    int territoriosJogador = 0;
-    int temVermelho = 0, temVerde = 0;
-    int americaSul = 0, africa = 0;
+    if (idMissao < 1 || idMissao > catalogoMissoes.quantidade) {
+        return 0;
+    }
     
-    // Contabiliza territorios e verifica presenca de cores
-    for (int i = 0; i < NUM_TERRITORIOS; i++) {
-        if (strcmp(mapa[i].corExercito, corJogador) == 0) {
-            territoriosJogador++;
-        }
+    EstadoPosse estado;
+    extrairEstadoPosse(mapa, corJogador, &estado);
+    return avaliarMissao(&catalogoMissoes.missoes[idMissao - 1], &estado);
+}
+
+// carregarMissoes():
+// Le as definicoes de missao do arquivo (uma por linha, '#' inicia comentario) e compila cada uma.
+// Linhas invalidas sao informadas e ignoradas. Sem arquivo ou sem missoes validas, usa MISSOES_PADRAO.
+// Retorna o numero de missoes carregadas.
+int carregarMissoes(const char* caminho) {
+    catalogoMissoes.quantidade = 0;
+    
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo != NULL) {
+        char linha[MAX_LINHA_MISSAO];
+        int numeroLinha = 0;
         
-        if (strcmp(mapa[i].corExercito, "Vermelho") == 0) {
-            temVermelho = 1;
+        while (fgets(linha, sizeof(linha), arquivo) != NULL && catalogoMissoes.quantidade < MAX_MISSOES) {
+            numeroLinha++;
+            linha[strcspn(linha, "\r\n")] = 0;
+            
+            const char* inicio = linha + strspn(linha, " \t");
+            if (*inicio == '\0' || *inicio == '#') {
+                continue;
+            }
+            
+            if (compilarMissao(inicio, &catalogoMissoes.missoes[catalogoMissoes.quantidade])) {
+                catalogoMissoes.quantidade++;
+            } else {
+                printf("%s:%d: missao ignorada.\n", caminho, numeroLinha);
+            }
+        }
+        fclose(arquivo);
+    }
+    
+    if (catalogoMissoes.quantidade == 0) {
+        for (int i = 0; i < NUM_MISSOES; i++) {
+            compilarMissao(MISSOES_PADRAO[i], &catalogoMissoes.missoes[i]);
+        }
+        catalogoMissoes.quantidade = NUM_MISSOES;
+    }
+    
+    return catalogoMissoes.quantidade;
+}
+
+// compilarMissao():
+// Compila uma linha no formato "<condicoes> | <descricao>" para bytecode.
+// Condicoes, separadas por "and":
+//   destroy <Cor>
+//   own <N>
+//   own <N> with >= <T> troops
+//   own continent <Continente> [and <Continente> ...]
+// Retorna 1 em caso de sucesso e 0 se a linha for invalida (o motivo e exibido).
+int compilarMissao(const char* linha, MissaoCompilada* missao) {
+    char texto[MAX_LINHA_MISSAO];
+    strncpy(texto, linha, sizeof(texto) - 1);
+    texto[sizeof(texto) - 1] = '\0';
+    
+    // Separa a descricao; sem ela, a propria condicao e usada como descricao
+    char* separador = strchr(texto, '|');
+    const char* descricao = linha;
+    if (separador != NULL) {
+        *separador = '\0';
+        descricao = separador + 1 + strspn(separador + 1, " \t");
+    }
+    strncpy(missao->descricao, descricao, MAX_DESCRICAO - 1);
+    missao->descricao[MAX_DESCRICAO - 1] = '\0';
+    
+    // Divide as condicoes em palavras
+    char* tokens[MAX_BYTECODE];
+    int numTokens = 0;
+    for (char* tok = strtok(texto, " \t"); tok != NULL; tok = strtok(NULL, " \t")) {
+        if (numTokens == MAX_BYTECODE) {
+            printf("Erro de missao: condicao longa demais.\n");
+            return 0;
+        }
+        tokens[numTokens++] = tok;
+    }
+    
+    if (numTokens == 0) {
+        printf("Erro de missao: nenhuma condicao definida.\n");
+        return 0;
+    }
+    
+    unsigned char* codigo = missao->codigo;
+    int tam = 0;
+    int i = 0;
+    
+    // Cada condicao ocupa no maximo 4 bytes; reserva 1 para OP_FIM
+    while (i < numTokens) {
+        if (tam + 5 > MAX_BYTECODE) {
+            printf("Erro de missao: condicoes demais.\n");
+            return 0;
         }
         
-        if (strcmp(mapa[i].corExercito, "Verde") == 0) {
-            temVerde = 1;
+        if (strcmp(tokens[i], "destroy") == 0) {
+            int cor = (i + 1 < numTokens) ? indiceCor(tokens[i + 1]) : -1;
+            if (cor < 0) {
+                printf("Erro de missao: cor invalida apos 'destroy'.\n");
+                return 0;
+            }
+            codigo[tam++] = OP_SEM_COR;
+            codigo[tam++] = (unsigned char)cor;
+            i += 2;
+        } else if (strcmp(tokens[i], "own") == 0 && i + 1 < numTokens && strcmp(tokens[i + 1], "continent") == 0) {
+            i += 2;
+            do {
+                int continente = (i < numTokens) ? indiceContinente(tokens[i]) : -1;
+                if (continente < 0) {
+                    printf("Erro de missao: continente invalido apos 'own continent'.\n");
+                    return 0;
+                }
+                if (tam + 3 > MAX_BYTECODE) {
+                    printf("Erro de missao: condicoes demais.\n");
+                    return 0;
+                }
+                codigo[tam++] = OP_CONTINENTE;
+                codigo[tam++] = (unsigned char)continente;
+                i++;
+                
+                // "and <Continente>" continua a lista; "and <condicao>" e tratado abaixo
+                if (i + 1 < numTokens && strcmp(tokens[i], "and") == 0 && indiceContinente(tokens[i + 1]) >= 0) {
+                    i++;
+                } else {
+                    break;
+                }
+            } while (1);
+        } else if (strcmp(tokens[i], "own") == 0) {
+            char* fim;
+            long n = (i + 1 < numTokens) ? strtol(tokens[i + 1], &fim, 10) : -1;
+            if (n < 0 || n > 0xFFFF || (i + 1 < numTokens && *fim != '\0')) {
+                printf("Erro de missao: quantidade invalida apos 'own'.\n");
+                return 0;
+            }
+            i += 2;
+            
+            if (i < numTokens && strcmp(tokens[i], "with") == 0) {
+                long t = -1;
+                if (i + 3 < numTokens && strcmp(tokens[i + 1], ">=") == 0 && strcmp(tokens[i + 3], "troops") == 0) {
+                    t = strtol(tokens[i + 2], &fim, 10);
+                    if (*fim != '\0') t = -1;
+                }
+                if (t < 0 || t > MAX_TROPAS_HIST) {
+                    printf("Erro de missao: use 'own N with >= T troops' (T ate %d).\n", MAX_TROPAS_HIST);
+                    return 0;
+                }
+                codigo[tam++] = OP_POSSUI_COM_TROPAS;
+                codigo[tam++] = (unsigned char)(n & 0xFF);
+                codigo[tam++] = (unsigned char)(n >> 8);
+                codigo[tam++] = (unsigned char)t;
+                i += 4;
+            } else {
+                codigo[tam++] = OP_POSSUI;
+                codigo[tam++] = (unsigned char)(n & 0xFF);
+                codigo[tam++] = (unsigned char)(n >> 8);
+            }
+        } else {
+            printf("Erro de missao: condicao desconhecida '%s'.\n", tokens[i]);
+            return 0;
         }
         
-        // Verifica America do Sul (territorios 0-5) e Africa (territorios 18-23)
-        if ((i >= 0 && i <= 5) && strcmp(mapa[i].corExercito, corJogador) == 0) {
-            americaSul++;
+        if (i < numTokens) {
+            if (strcmp(tokens[i], "and") != 0 || i + 1 == numTokens) {
+                printf("Erro de missao: esperado 'and' seguido de outra condicao.\n");
+                return 0;
+            }
+            i++;
+        }
+    }
+    
+    codigo[tam++] = OP_FIM;
+    missao->tamanho = tam;
+    return 1;
+}
+
+// extrairEstadoPosse():
+// Percorre o mapa uma unica vez e resume o que as missoes consultam: territorios por cor,
+// territorios e continentes do jogador e quantos territorios do jogador tem pelo menos T tropas.
+void extrairEstadoPosse(const Territorio* mapa, const char* corJogador, EstadoPosse* estado) {
+    memset(estado, 0, sizeof(*estado));
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        int cor = indiceCor(mapa[i].corExercito);
+        if (cor >= 0) {
+            estado->territoriosPorCor[cor]++;
         }
         
-        if ((i >= 18 && i <= 23) && strcmp(mapa[i].corExercito, corJogador) == 0) {
-            africa++;
+        if (strcmp(mapa[i].corExercito, corJogador) == 0) {
+            estado->territoriosJogador++;
+            estado->continenteJogador[continenteDoTerritorio(i)]++;
+            int tropas = mapa[i].numTropas;
+            if (tropas < 0) tropas = 0;
+            if (tropas > MAX_TROPAS_HIST) tropas = MAX_TROPAS_HIST;
+            estado->jogadorComTropas[tropas]++;
         }
     }
     
-    switch (idMissao) {
-        case 1:
-            return !temVermelho; // Verdadeiro se nao ha mais exercito vermelho
-        case 2:
-            return !temVerde; // Verdadeiro se nao ha mais exercito verde
-        case 3:
-            return territoriosJogador >= 18;
-        case 4:
-            return territoriosJogador >= 24;
-        case 5:
-            return (americaSul == 6 && africa == 6); // America do Sul e Africa completas
-        default:
-            return 0;
+    // Acumula de tras para frente: [t] passa a contar territorios com t ou mais tropas
+    for (int t = MAX_TROPAS_HIST - 1; t >= 0; t--) {
+        estado->jogadorComTropas[t] += estado->jogadorComTropas[t + 1];
+    }
+}
+
+// avaliarMissao():
+// Interpretador do bytecode de missoes. Retorna 1 se todas as condicoes forem verdadeiras.
+int avaliarMissao(const MissaoCompilada* missao, const EstadoPosse* estado) {
+    const unsigned char* pc = missao->codigo;
+    
+    for (;;) {
+        switch (pc[0]) {
+            case OP_FIM:
+                return 1;
+            case OP_SEM_COR:
+                if (estado->territoriosPorCor[pc[1]] != 0) return 0;
+                pc += 2;
+                break;
+            case OP_POSSUI:
+                if (estado->territoriosJogador < (pc[1] | (pc[2] << 8))) return 0;
+                pc += 3;
+                break;
+            case OP_POSSUI_COM_TROPAS:
+                if (estado->jogadorComTropas[pc[3]] < (pc[1] | (pc[2] << 8))) return 0;
+                pc += 4;
+                break;
+            case OP_CONTINENTE:
+                if (estado->continenteJogador[pc[1]] < CONTINENTES[pc[1]].quantidade) return 0;
+                pc += 2;
+                break;
+            default:
+                return 0;
+        }
+    }
+}
+
+// indiceCor():
+// Retorna o indice da cor em NOMES_CORES, ou -1 se a cor nao existir.
+int indiceCor(const char* cor) {
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (strcmp(NOMES_CORES[i], cor) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// indiceContinente():
+// Retorna o indice do continente pelo nome usado na DSL de missoes, ou -1.
+int indiceContinente(const char* nome) {
+    for (int i = 0; i < NUM_CONTINENTES; i++) {
+        if (strcmp(CONTINENTES[i].nome, nome) == 0) {
+            return i;
+        }
     }
+    return -1;
+}
+
+// continenteDoTerritorio():
+// Retorna o indice do continente ao qual o territorio pertence.
+int continenteDoTerritorio(int indice) {
+    for (int i = NUM_CONTINENTES - 1; i > 0; i--) {
+        if (indice >= CONTINENTES[i].inicio) {
+            return i;
+        }
+    }
+    return 0;
 }
 
 // limparBufferEntrada():
@@ -584,11 +1841,9 @@ void limparBufferEntrada(void) {
 // calcularEstatisticas():
 // Calcula estatisticas para todos os exercitos no mapa.
 void calcularEstatisticas(const Territorio* mapa, EstatisticaExercito estatisticas[]) {
-    const char* cores[NUM_CORES] = {"Vermelho", "Verde", "Amarelo", "Preto", "Branco", "Rosa"};
-    
     // Inicializa estatisticas
     for (int i = 0; i < NUM_CORES; i++) {
-        strcpy(estatisticas[i].cor, cores[i]);
+        strcpy(estatisticas[i].cor, NOMES_CORES[i]);
         estatisticas[i].territorios = 0;
         estatisticas[i].tropasTotal = 0;
         estatisticas[i].vidaTotal = 0;
@@ -598,19 +1853,16 @@ void calcularEstatisticas(const Territorio* mapa, EstatisticaExercito estatistic
     
     // Calcula estatisticas para cada territorio
     for (int i = 0; i < NUM_TERRITORIOS; i++) {
-        for (int j = 0; j < NUM_CORES; j++) {
-            if (strcmp(mapa[i].corExercito, cores[j]) == 0) {
-                estatisticas[j].territorios++;
-                estatisticas[j].tropasTotal += mapa[i].numTropas;
-                estatisticas[j].vidaTotal += mapa[i].vida;
-                estatisticas[j].poderTotal += mapa[i].poder;
-                // Pontos baseados em territorios, tropas e atributos
-                estatisticas[j].pontos = estatisticas[j].territorios * 10 + 
-                                       estatisticas[j].tropasTotal * 2 + 
-                                       (estatisticas[j].vidaTotal + estatisticas[j].poderTotal) / 100;
-                break;
-            }
-        }
+        int j = indiceCor(mapa[i].corExercito);
+        if (j < 0) continue; // Cor fora da tabela (ex.: cor padrao do jogador)
+        estatisticas[j].territorios++;
+        estatisticas[j].tropasTotal += mapa[i].numTropas;
+        estatisticas[j].vidaTotal += mapa[i].vida;
+        estatisticas[j].poderTotal += mapa[i].poder;
+        // Pontos baseados em territorios, tropas e atributos
+        estatisticas[j].pontos = estatisticas[j].territorios * 10 + 
+                               estatisticas[j].tropasTotal * 2 + 
+                               (estatisticas[j].vidaTotal + estatisticas[j].poderTotal) / 100;
     }
 }
 
@@ -697,10 +1949,15 @@ void exibirStatusGeral(const Territorio* mapa, const Jogador* jogador) {
 }
 
 // atualizarPontuacao():
-// Atualiza pontuacao do jogador baseada em acoes.
+// Atualiza pontuacao do jogador baseada em acoes e repassa a acao ao placar global.
+// tipoAcao: 1 = batalha vencida, 2 = territorio conquistado, 3 = batalha perdida.
 void atualizarPontuacao(Jogador* jogador, int tipoAcao, int valor) {
+    int antes = jogador->pontos;
     jogador->pontos += valor;
     if (jogador->pontos < 0) jogador->pontos = 0; // Nao permite pontos negativos
+    
+    // O placar recebe a variacao efetivamente aplicada, ja com o limite em zero
+    placarSomar(jogador->idPlacar, jogador->pontos - antes, tipoAcao == 1, tipoAcao == 2);
 }
 
 // exibirResultadoFinal():
@@ -786,7 +2043,8 @@ void exibirMapaComStatus(const Territorio* mapa, const Jogador* jogador) {
 
 // analisarRelacoesDiplomaticas():
 // Analisa e exibe informacoes detalhadas sobre inimigos e aliados.
-void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador) {
+// A pressao de cada inimigo e o apoio dos territorios atacaveis vem do mapa de influencia.
+void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador, const MapaInfluencia* influencia) {
     printf("\n=== ANALISE DIPLOMATICA ===\n");
     
     // Conta territorios por cor
@@ -795,32 +2053,22 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
     int vidaPorCor[NUM_CORES] = {0};
     int poderPorCor[NUM_CORES] = {0};
     
-    const char* cores[NUM_CORES] = {"Vermelho", "Verde", "Amarelo", "Preto", "Branco", "Rosa"};
-    
     for (int i = 0; i < NUM_TERRITORIOS; i++) {
-        for (int j = 0; j < NUM_CORES; j++) {
-            if (strcmp(mapa[i].corExercito, cores[j]) == 0) {
-                territoriosPorCor[j]++;
-                tropasPorCor[j] += mapa[i].numTropas;
-                vidaPorCor[j] += mapa[i].vida;
-                poderPorCor[j] += mapa[i].poder;
-                break;
-            }
+        int j = indiceCor(mapa[i].corExercito);
+        if (j >= 0) {
+            territoriosPorCor[j]++;
+            tropasPorCor[j] += mapa[i].numTropas;
+            vidaPorCor[j] += mapa[i].vida;
+            poderPorCor[j] += mapa[i].poder;
         }
     }
     
     // Identifica a cor do jogador
-    int indiceJogador = -1;
-    for (int i = 0; i < NUM_CORES; i++) {
-        if (strcmp(cores[i], jogador->cor) == 0) {
-            indiceJogador = i;
-            break;
-        }
-    }
+    int indiceJogador = indiceCor(jogador->cor);
     
     printf("\n=== SEUS TERRITORIOS ===\n");
     if (indiceJogador >= 0) {
-        printf("Cor: %s\n", cores[indiceJogador]);
+        printf("Cor: %s\n", NOMES_CORES[indiceJogador]);
         printf("Territorios: %d\n", territoriosPorCor[indiceJogador]);
         printf("Tropas totais: %d\n", tropasPorCor[indiceJogador]);
         printf("Vida total: %d\n", vidaPorCor[indiceJogador]);
@@ -828,11 +2076,19 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
     }
     
     printf("\n=== FORCAS INIMIGAS ===\n");
-    printf("%-10s %-5s %-7s %-8s %-8s %s\n", "COR", "TERR", "TROPAS", "VIDA", "PODER", "AMEACA");
-    printf("====================================================\n");
+    printf("%-10s %-5s %-7s %-8s %-8s %-7s %s\n", "COR", "TERR", "TROPAS", "VIDA", "PODER", "AMEACA", "PRESSAO");
+    printf("============================================================\n");
     
     for (int i = 0; i < NUM_CORES; i++) {
         if (i != indiceJogador && territoriosPorCor[i] > 0) {
+            // Pressao: influencia desta cor somada sobre os territorios do jogador
+            double pressao = 0;
+            for (int t = 0; t < NUM_TERRITORIOS; t++) {
+                if (strcmp(mapa[t].corExercito, jogador->cor) == 0) {
+                    pressao += influenciaDaCor(influencia, t, i);
+                }
+            }
+            
             // Calcula nivel de ameaca
             int forcaTotal = tropasPorCor[i] + (vidaPorCor[i] + poderPorCor[i]) / 100;
             char ameaca[10];
@@ -841,17 +2097,36 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
             else if (forcaTotal > 50) strcpy(ameaca, "MEDIA");
             else strcpy(ameaca, "BAIXA");
             
-            printf("%-10s %-5d %-7d %-8d %-8d %s\n", 
-                   cores[i], 
+            printf("%-10s %-5d %-7d %-8d %-8d %-7s %.1f\n", 
+                   NOMES_CORES[i], 
                    territoriosPorCor[i],
                    tropasPorCor[i],
                    vidaPorCor[i],
                    poderPorCor[i],
-                   ameaca);
+                   ameaca,
+                   pressao);
         }
     }
     
-    printf("====================================================\n");
+    printf("============================================================\n");
+    
+    // Territorios do jogador mais ameacados pela vizinhanca
+    printf("\n=== SEUS TERRITORIOS MAIS AMEACADOS ===\n");
+    int exibidos[NUM_TERRITORIOS] = {0};
+    for (int k = 0; k < 5; k++) {
+        int maisAmeacado = -1;
+        for (int t = 0; t < NUM_TERRITORIOS; t++) {
+            if (!exibidos[t] && strcmp(mapa[t].corExercito, jogador->cor) == 0 &&
+                (maisAmeacado < 0 || influenciaAmeaca(influencia, t) > influenciaAmeaca(influencia, maisAmeacado))) {
+                maisAmeacado = t;
+            }
+        }
+        if (maisAmeacado < 0) break;
+        exibidos[maisAmeacado] = 1;
+        printf("%-3d %-20s Tropas: %-4d Ameaca: %.1f\n", maisAmeacado + 1, mapa[maisAmeacado].nome,
+               mapa[maisAmeacado].numTropas, influenciaAmeaca(influencia, maisAmeacado));
+    }
+    printf("=======================================\n");
     
     // Recomendacoes estrategicas
     printf("\n=== RECOMENDACOES ESTRATEGICAS ===\n");
@@ -865,7 +2140,7 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
             int forca = tropasPorCor[i] + (vidaPorCor[i] + poderPorCor[i]) / 100;
             if (forca < menorForca) {
                 menorForca = forca;
-                strcpy(inimigoMaisfraco, cores[i]);
+                strcpy(inimigoMaisfraco, NOMES_CORES[i]);
             }
         }
     }
@@ -879,7 +2154,7 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
             int forca = tropasPorCor[i] + (vidaPorCor[i] + poderPorCor[i]) / 100;
             if (forca > maiorForca) {
                 maiorForca = forca;
-                strcpy(inimigoMaisForte, cores[i]);
+                strcpy(inimigoMaisForte, NOMES_CORES[i]);
             }
         }
     }
@@ -900,8 +2175,8 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
     
     // Lista de territorios atacaveis
     printf("\n=== TERRITORIOS ATACAVEIS ===\n");
-    printf("%-3s %-20s %-10s %-6s %s\n", "ID", "TERRITORIO", "COR", "TROPAS", "DIFICULDADE");
-    printf("=================================================\n");
+    printf("%-3s %-20s %-10s %-6s %-11s %-7s %s\n", "ID", "TERRITORIO", "COR", "TROPAS", "DIFICULDADE", "APOIO", "SEU ALCANCE");
+    printf("=======================================================================\n");
     
     for (int i = 0; i < NUM_TERRITORIOS; i++) {
         if (strcmp(mapa[i].corExercito, jogador->cor) != 0) {
@@ -912,14 +2187,3490 @@ void analisarRelacoesDiplomaticas(const Territorio* mapa, const Jogador* jogador
             else if (resistencia > 8) strcpy(dificuldade, "MEDIO");
             else strcpy(dificuldade, "FACIL");
             
-            printf("%-3d %-20s %-10s %-6d %s\n", 
+            // Apoio: influencia do dono sobre o territorio; alcance: influencia do jogador
+            printf("%-3d %-20s %-10s %-6d %-11s %-7.1f %.1f\n", 
                    i + 1,
                    mapa[i].nome, 
                    mapa[i].corExercito, 
                    mapa[i].numTropas,
-                   dificuldade);
+                   dificuldade,
+                   influenciaDaCor(influencia, i, corInfluencia(mapa[i].corExercito)),
+                   influenciaDaCor(influencia, i, corInfluencia(jogador->cor)));
+        }
+    }
+    
+    printf("=======================================================================\n");
+}
+
+// estadoCriar():
+// Cria um estado copy-on-write a partir do mapa e do jogador atuais.
+// Retorna 1 em caso de sucesso ou 0 se faltar memoria.
+int estadoCriar(EstadoJogo* estado, const Territorio* mapa, const Jogador* jogador) {
+    estado->jogador = *jogador;
+    estado->jogador.idPlacar = 0; // Ataques hipoteticos nao pontuam no placar global
+    estado->tabela = (TabelaBlocos*)calloc(1, sizeof(TabelaBlocos));
+    if (estado->tabela == NULL) {
+        return 0;
+    }
+    estado->tabela->referencias = 1;
+    
+    for (int b = 0; b < NUM_BLOCOS; b++) {
+        BlocoTerritorios* bloco = (BlocoTerritorios*)calloc(1, sizeof(BlocoTerritorios));
+        if (bloco == NULL) {
+            estadoLiberar(estado);
+            return 0;
+        }
+        bloco->referencias = 1;
+        
+        int inicio = b * TAMANHO_BLOCO;
+        int quantidade = (NUM_TERRITORIOS - inicio < TAMANHO_BLOCO) ? NUM_TERRITORIOS - inicio : TAMANHO_BLOCO;
+        memcpy(bloco->territorios, &mapa[inicio], quantidade * sizeof(Territorio));
+        estado->tabela->blocos[b] = bloco;
+    }
+    return 1;
+}
+
+// estadoSnapshot():
+// Tira um snapshot O(1) do estado: a copia apenas passa a compartilhar a mesma tabela.
+void estadoSnapshot(const EstadoJogo* origem, EstadoJogo* copia) {
+    copia->tabela = origem->tabela;
+    copia->jogador = origem->jogador;
+    copia->tabela->referencias++;
+}
+
+// estadoLiberar():
+// Solta a referencia do estado, liberando tabela e blocos que ninguem mais usa.
+void estadoLiberar(EstadoJogo* estado) {
+    TabelaBlocos* tabela = estado->tabela;
+    estado->tabela = NULL;
+    
+    if (tabela == NULL || --tabela->referencias > 0) {
+        return;
+    }
+    
+    for (int b = 0; b < NUM_BLOCOS; b++) {
+        if (tabela->blocos[b] != NULL && --tabela->blocos[b]->referencias == 0) {
+            free(tabela->blocos[b]);
+        }
+    }
+    free(tabela);
+}
+
+// estadoLer():
+// Retorna o territorio para leitura, sem copiar nada.
+const Territorio* estadoLer(const EstadoJogo* estado, int indice) {
+    return &estado->tabela->blocos[indice / TAMANHO_BLOCO]->territorios[indice % TAMANHO_BLOCO];
+}
+
+// estadoEscrever():
+// Retorna o territorio para escrita. Copia a tabela se ela for compartilhada com outro
+// snapshot e depois apenas o bloco do territorio, se este tambem for compartilhado.
+// Retorna NULL se faltar memoria.
+Territorio* estadoEscrever(EstadoJogo* estado, int indice) {
+    if (estado->tabela->referencias > 1) {
+        TabelaBlocos* copia = (TabelaBlocos*)malloc(sizeof(TabelaBlocos));
+        if (copia == NULL) {
+            return NULL;
+        }
+        *copia = *estado->tabela;
+        copia->referencias = 1;
+        for (int b = 0; b < NUM_BLOCOS; b++) {
+            copia->blocos[b]->referencias++;
+        }
+        estado->tabela->referencias--;
+        estado->tabela = copia;
+    }
+    
+    BlocoTerritorios** bloco = &estado->tabela->blocos[indice / TAMANHO_BLOCO];
+    if ((*bloco)->referencias > 1) {
+        BlocoTerritorios* copia = (BlocoTerritorios*)malloc(sizeof(BlocoTerritorios));
+        if (copia == NULL) {
+            return NULL;
+        }
+        *copia = **bloco;
+        copia->referencias = 1;
+        (*bloco)->referencias--;
+        *bloco = copia;
+    }
+    
+    return &(*bloco)->territorios[indice % TAMANHO_BLOCO];
+}
+
+// estadoParaMapa():
+// Copia o estado para um vetor de territorios comum.
+void estadoParaMapa(const EstadoJogo* estado, Territorio* mapa) {
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        mapa[i] = *estadoLer(estado, i);
+    }
+}
+
+// estadoSimularAtaque():
+// Resolve um ataque sobre o estado sem saida na tela; apenas os blocos dos dois
+// territorios envolvidos sao copiados, e so depois de o ataque ser validado.
+// Usada pela analise hipotetica.
+ResultadoBatalha estadoSimularAtaque(EstadoJogo* estado, int origem, int destino, int tropasAtaque) {
+    ResultadoBatalha resultado = {0};
+    resultado.status = validarAtaque(estadoLer(estado, origem), estadoLer(estado, destino), &estado->jogador);
+    if (resultado.status != ATAQUE_REALIZADO) {
+        return resultado;
+    }
+    
+    Territorio* territorioOrigem = estadoEscrever(estado, origem);
+    Territorio* territorioDestino = estadoEscrever(estado, destino);
+    if (territorioOrigem == NULL || territorioDestino == NULL) {
+        resultado.status = ATAQUE_SEM_MEMORIA;
+        return resultado;
+    }
+    return resolverAtaque(territorioOrigem, territorioDestino, &estado->jogador, tropasAtaque);
+}
+
+// historicoIniciar():
+// Inicia o historico com um snapshot do estado inicial.
+void historicoIniciar(HistoricoEstados* historico, const EstadoJogo* inicial) {
+    estadoSnapshot(inicial, &historico->estados[0]);
+    historico->quantidade = 1;
+    historico->atual = 0;
+}
+
+// historicoRegistrar():
+// Registra um snapshot do estado apos uma acao, descartando o que podia ser refeito.
+// Quando o historico enche, o estado mais antigo e descartado.
+void historicoRegistrar(HistoricoEstados* historico, const EstadoJogo* estado) {
+    while (historico->quantidade > historico->atual + 1) {
+        estadoLiberar(&historico->estados[--historico->quantidade]);
+    }
+    
+    if (historico->quantidade == MAX_HISTORICO) {
+        estadoLiberar(&historico->estados[0]);
+        memmove(&historico->estados[0], &historico->estados[1], (MAX_HISTORICO - 1) * sizeof(EstadoJogo));
+        historico->quantidade--;
+        historico->atual--;
+    }
+    
+    estadoSnapshot(estado, &historico->estados[historico->quantidade++]);
+    historico->atual = historico->quantidade - 1;
+}
+
+// historicoDesfazer():
+// Volta o estado para o snapshot anterior. Retorna 0 se nao houver o que desfazer.
+int historicoDesfazer(HistoricoEstados* historico, EstadoJogo* estado) {
+    if (historico->atual == 0) {
+        return 0;
+    }
+    historico->atual--;
+    estadoLiberar(estado);
+    estadoSnapshot(&historico->estados[historico->atual], estado);
+    return 1;
+}
+
+// historicoRefazer():
+// Avanca o estado para o snapshot seguinte. Retorna 0 se nao houver o que refazer.
+int historicoRefazer(HistoricoEstados* historico, EstadoJogo* estado) {
+    if (historico->atual + 1 >= historico->quantidade) {
+        return 0;
+    }
+    historico->atual++;
+    estadoLiberar(estado);
+    estadoSnapshot(&historico->estados[historico->atual], estado);
+    return 1;
+}
+
+// historicoLiberar():
+// Libera todos os snapshots do historico.
+void historicoLiberar(HistoricoEstados* historico) {
+    for (int i = 0; i < historico->quantidade; i++) {
+        estadoLiberar(&historico->estados[i]);
+    }
+    historico->quantidade = 0;
+    historico->atual = 0;
+}
+
+// analiseHipotetica():
+// Tela de "e se?": permite atacar, desfazer e refazer sobre um snapshot do mapa real.
+// Nada do que acontece aqui altera o mapa ou o jogador do jogo.
+void analiseHipotetica(const Territorio* mapa, const Jogador* jogador, PreCalculo* precalculo) {
+    // Batalhas hipoteticas nao entram no arquivo de batalhas
+    ExportadorBatalhas* exportador = exportadorDaThread;
+    exportadorAtivarNaThread(NULL);
+    
+    EstadoJogo estado;
+    if (!estadoCriar(&estado, mapa, jogador)) {
+        printf("Erro: Nao foi possivel alocar memoria para a analise!\n");
+        exportadorAtivarNaThread(exportador);
+        return;
+    }
+    
+    HistoricoEstados* historico = (HistoricoEstados*)malloc(sizeof(HistoricoEstados));
+    if (historico == NULL) {
+        printf("Erro: Nao foi possivel alocar memoria para a analise!\n");
+        estadoLiberar(&estado);
+        exportadorAtivarNaThread(exportador);
+        return;
+    }
+    historicoIniciar(historico, &estado);
+    
+    int opcao;
+    do {
+        printf("\n=== ANALISE HIPOTETICA ===\n");
+        printf("Pontos: %d | Vitorias: %d | Derrotas: %d | Conquistas: %d\n",
+               estado.jogador.pontos, estado.jogador.batalhasVencidas,
+               estado.jogador.batalhasPerdidas, estado.jogador.territoriosConquistados);
+        printf("1. Atacar (hipotetico)\n");
+        printf("2. Desfazer\n");
+        printf("3. Refazer\n");
+        printf("4. Ver mapa hipotetico\n");
+        printf("0. Voltar ao jogo\n");
+        printf("==========================\n");
+        opcao = lerOpcaoAssincrona(precalculo);
+        
+        switch (opcao) {
+            case 1: {
+                int origem = lerInteiroAssincrono(precalculo, "Digite o ID do territorio de origem (1-%d): ", NUM_TERRITORIOS);
+                int destino = lerInteiroAssincrono(precalculo, "Digite o ID do territorio de destino (1-%d): ", NUM_TERRITORIOS);
+                int tropasBatalha = lerInteiroAssincrono(precalculo, "Digite quantas tropas usar no ataque (1-%d): ",
+                                                         MAX_TROPAS_ATAQUE);
+                
+                if (origem < 1 || origem > NUM_TERRITORIOS || destino < 1 || destino > NUM_TERRITORIOS || origem == destino) {
+                    printf("IDs de territorios invalidos!\n");
+                    break;
+                }
+                if (tropasBatalha < 1 || tropasBatalha > MAX_TROPAS_ATAQUE) {
+                    printf("Numero de tropas invalido!\n");
+                    break;
+                }
+                if (strcmp(estadoLer(&estado, origem - 1)->corExercito, estado.jogador.cor) != 0) {
+                    printf("Voce nao pode atacar com um territorio que nao e seu!\n");
+                    break;
+                }
+                
+                // estadoSimularAtaque() valida antes de copiar os blocos; ataques recusados nao entram no historico
+                ResultadoBatalha resultado = estadoSimularAtaque(&estado, origem - 1, destino - 1, tropasBatalha);
+                exibirResultadoBatalha(estadoLer(&estado, origem - 1), estadoLer(&estado, destino - 1),
+                                       &estado.jogador, tropasBatalha, &resultado);
+                if (resultado.status != ATAQUE_REALIZADO) break;
+                historicoRegistrar(historico, &estado);
+                break;
+            }
+            case 2:
+                if (!historicoDesfazer(historico, &estado)) printf("Nada para desfazer.\n");
+                break;
+            case 3:
+                if (!historicoRefazer(historico, &estado)) printf("Nada para refazer.\n");
+                break;
+            case 4: {
+                Territorio copia[NUM_TERRITORIOS];
+                estadoParaMapa(&estado, copia);
+                exibirMapaComStatus(copia, &estado.jogador);
+                break;
+            }
+            case 0:
+                break;
+            default:
+                printf("Opcao invalida! Tente novamente.\n");
+                break;
+        }
+    } while (opcao != 0);
+    
+    historicoLiberar(historico);
+    free(historico);
+    estadoLiberar(&estado);
+    exportadorAtivarNaThread(exportador);
+}
+
+// hashNome():
+// Hash FNV-1a do nome, usado para posicionar o jogador no placar.
+static unsigned long hashNome(const char* nome) {
+    unsigned long hash = 2166136261UL;
+    for (const unsigned char* p = (const unsigned char*)nome; *p; p++) {
+        hash = (hash ^ *p) * 16777619UL;
+    }
+    return hash;
+}
+
+// placarRegistrarJogador():
+// Localiza o jogador no placar pelo nome ou o insere em uma entrada livre (enderecamento aberto).
+// A insercao reserva a entrada com compare-and-swap, sem travas.
+// Retorna o id do jogador no placar (1 em diante) ou 0 se o placar estiver cheio.
+int placarRegistrarJogador(const char* nome) {
+    unsigned long hash = hashNome(nome);
+    
+    for (int tentativa = 0; tentativa < PLACAR_MAX_JOGADORES; tentativa++) {
+        int i = (int)((hash + tentativa) % PLACAR_MAX_JOGADORES);
+        EntradaPlacar* entrada = &placarGlobal.jogadores[i];
+        int estado = atomic_load_explicit(&entrada->estado, memory_order_acquire);
+        
+        if (estado == PLACAR_LIVRE) {
+            int esperado = PLACAR_LIVRE;
+            if (atomic_compare_exchange_strong(&entrada->estado, &esperado, PLACAR_RESERVANDO)) {
+                entrada->hash = hash;
+                strncpy(entrada->nome, nome, MAX_NOME - 1);
+                entrada->nome[MAX_NOME - 1] = '\0';
+                atomic_store_explicit(&entrada->estado, PLACAR_PRONTO, memory_order_release);
+                return i + 1;
+            }
+            estado = esperado;
+        }
+        
+        // Outra thread esta escrevendo o nome nesta entrada; aguarda ela terminar
+        while (estado == PLACAR_RESERVANDO) {
+            estado = atomic_load_explicit(&entrada->estado, memory_order_acquire);
+        }
+        
+        if (entrada->hash == hash && strncmp(entrada->nome, nome, MAX_NOME - 1) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// placarFragmentoAtual():
+// Retorna o fragmento onde a thread atual deve somar. Enquanto a thread nao tem fragmento proprio,
+// cada chamada tenta reservar um unico candidato; se ele estiver ocupado a soma vai para esse mesmo
+// fragmento (as somas sao atomicas) e a proxima chamada tenta o seguinte. Assim a reserva acaba
+// acontecendo quando algum fragmento for liberado, sem varrer todos a cada escrita.
+static FragmentoPlacar* placarFragmentoAtual(void) {
+    if (fragmentoDaThread >= 0) {
+        return &placarGlobal.fragmentos[fragmentoDaThread];
+    }
+    if (fragmentoCandidato == 0) {
+        // Ponto de partida diferente por thread: o endereco da variavel thread-local (nunca 0)
+        fragmentoCandidato = (unsigned)((size_t)&fragmentoCandidato >> 6) + PLACAR_NUM_FRAGMENTOS;
+    }
+    int candidato = (int)(fragmentoCandidato++ % PLACAR_NUM_FRAGMENTOS);
+    int livre = 0;
+    if (atomic_compare_exchange_strong(&placarGlobal.fragmentos[candidato].ocupado, &livre, 1)) {
+        fragmentoDaThread = candidato;
+    }
+    return &placarGlobal.fragmentos[candidato];
+}
+
+// placarLiberarFragmento():
+// Devolve o fragmento da thread atual para que outra thread possa reserva-lo.
+// Os contadores acumulados permanecem no fragmento. Chamar quando a thread deixa de pontuar.
+void placarLiberarFragmento(void) {
+    if (fragmentoDaThread >= 0) {
+        atomic_store(&placarGlobal.fragmentos[fragmentoDaThread].ocupado, 0);
+    }
+    fragmentoDaThread = -1;
+}
+
+// placarSomar():
+// Acumula pontos e contadores do jogador no fragmento da thread atual.
+// Nenhum id (0) significa que o jogador nao participa do placar.
+void placarSomar(int idPlacar, long pontos, long batalhasVencidas, long territoriosConquistados) {
+    if (idPlacar <= 0 || idPlacar > PLACAR_MAX_JOGADORES) {
+        return;
+    }
+    
+    FragmentoPlacar* fragmento = placarFragmentoAtual();
+    int i = idPlacar - 1;
+    
+    atomic_fetch_add_explicit(&fragmento->escritasIniciadas, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_fetch_add_explicit(&fragmento->pontos[i], pontos, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fragmento->batalhasVencidas[i], batalhasVencidas, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fragmento->territoriosConquistados[i], territoriosConquistados, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fragmento->escritasConcluidas, 1, memory_order_release);
+}
+
+// placarSomarFragmento():
+// Acumula os contadores de um fragmento nos totais da consulta. Como cada escrita altera um unico
+// jogador, a validacao e feita jogador a jogador: os tres contadores so sao aceitos se nenhuma
+// escrita no fragmento estava em andamento nem comecou durante a leitura, o que mantem a janela
+// curta mesmo com o fragmento dividido. Apos PLACAR_TENTATIVAS_LEITURA tentativas a ultima leitura
+// e usada assim mesmo (cada contador e atomico, mas uma escrita em andamento pode aparecer pela
+// metade). Escritores nunca esperam por leitores.
+static void placarSomarFragmento(const FragmentoPlacar* fragmento, long pontos[], long vencidas[], long conquistados[]) {
+    for (int i = 0; i < PLACAR_MAX_JOGADORES; i++) {
+        long lidoPontos = 0, lidoVencidas = 0, lidoConquistados = 0;
+        for (int tentativa = 0; tentativa < PLACAR_TENTATIVAS_LEITURA; tentativa++) {
+            unsigned long concluidas = atomic_load_explicit(&fragmento->escritasConcluidas, memory_order_acquire);
+            unsigned long iniciadas = atomic_load_explicit(&fragmento->escritasIniciadas, memory_order_acquire);
+            if (iniciadas != concluidas && tentativa < PLACAR_TENTATIVAS_LEITURA - 1) {
+                sched_yield(); // Ha escrita em andamento; o escritor pode ter sido interrompido no meio
+                continue;
+            }
+            lidoPontos = atomic_load_explicit(&fragmento->pontos[i], memory_order_relaxed);
+            lidoVencidas = atomic_load_explicit(&fragmento->batalhasVencidas[i], memory_order_relaxed);
+            lidoConquistados = atomic_load_explicit(&fragmento->territoriosConquistados[i], memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&fragmento->escritasIniciadas, memory_order_relaxed) == iniciadas) {
+                break;
+            }
+            sched_yield();
+        }
+        pontos[i] += lidoPontos;
+        vencidas[i] += lidoVencidas;
+        conquistados[i] += lidoConquistados;
+    }
+}
+
+// placarConsultar():
+// Consolida todos os fragmentos em 'posicoes'. Cada escrita e vista inteira ou nao e vista, mas
+// escritas em fragmentos diferentes podem entrar em momentos diferentes da varredura.
+// Retorna o numero de jogadores preenchidos.
+int placarConsultar(PosicaoPlacar posicoes[], int maximo) {
+    static _Thread_local long totalPontos[PLACAR_MAX_JOGADORES];
+    static _Thread_local long totalVencidas[PLACAR_MAX_JOGADORES];
+    static _Thread_local long totalConquistados[PLACAR_MAX_JOGADORES];
+    
+    memset(totalPontos, 0, sizeof(totalPontos));
+    memset(totalVencidas, 0, sizeof(totalVencidas));
+    memset(totalConquistados, 0, sizeof(totalConquistados));
+    for (int f = 0; f < PLACAR_NUM_FRAGMENTOS; f++) {
+        placarSomarFragmento(&placarGlobal.fragmentos[f], totalPontos, totalVencidas, totalConquistados);
+    }
+    
+    int quantidade = 0;
+    for (int i = 0; i < PLACAR_MAX_JOGADORES && quantidade < maximo; i++) {
+        const EntradaPlacar* entrada = &placarGlobal.jogadores[i];
+        if (atomic_load_explicit(&entrada->estado, memory_order_acquire) != PLACAR_PRONTO) {
+            continue;
+        }
+        strcpy(posicoes[quantidade].nome, entrada->nome);
+        posicoes[quantidade].pontos = totalPontos[i];
+        posicoes[quantidade].batalhasVencidas = totalVencidas[i];
+        posicoes[quantidade].territoriosConquistados = totalConquistados[i];
+        quantidade++;
+    }
+    return quantidade;
+}
+
+// placarTopK():
+// Preenche 'posicoes' com os k jogadores de maior pontuacao, em ordem decrescente.
+// Retorna quantos foram preenchidos.
+int placarTopK(PosicaoPlacar posicoes[], int k) {
+    PosicaoPlacar* todos = (PosicaoPlacar*)malloc(PLACAR_MAX_JOGADORES * sizeof(PosicaoPlacar));
+    if (todos == NULL) {
+        return 0;
+    }
+    int quantidade = placarConsultar(todos, PLACAR_MAX_JOGADORES);
+    
+    // Selecao parcial: so as k primeiras posicoes precisam ficar ordenadas
+    int preenchidos = (k < quantidade) ? k : quantidade;
+    for (int i = 0; i < preenchidos; i++) {
+        int melhor = i;
+        for (int j = i + 1; j < quantidade; j++) {
+            if (todos[j].pontos > todos[melhor].pontos) {
+                melhor = j;
+            }
         }
+        PosicaoPlacar temp = todos[i];
+        todos[i] = todos[melhor];
+        todos[melhor] = temp;
+        posicoes[i] = todos[i];
     }
     
-    printf("=================================================\n");
+    free(todos);
+    return preenchidos;
+}
+
+// exibirPlacarGlobal():
+// Exibe os melhores jogadores acumulados em todas as partidas.
+void exibirPlacarGlobal(const Jogador* jogador) {
+    PosicaoPlacar top[PLACAR_TOP];
+    int quantidade = placarTopK(top, PLACAR_TOP);
+    
+    printf("\n=== PLACAR GLOBAL ===\n");
+    printf("%-3s %-20s %-8s %-9s %s\n", "POS", "JOGADOR", "PONTOS", "VITORIAS", "CONQUISTAS");
+    printf("=======================================================\n");
+    for (int i = 0; i < quantidade; i++) {
+        printf("%-3d %-20s %-8ld %-9ld %ld %c\n",
+               i + 1,
+               top[i].nome,
+               top[i].pontos,
+               top[i].batalhasVencidas,
+               top[i].territoriosConquistados,
+               strcmp(top[i].nome, jogador->nome) == 0 ? '*' : ' ');
+    }
+    printf("=======================================================\n");
+}
+
+// placarSalvar():
+// Grava o placar consolidado em um arquivo temporario e o renomeia sobre o destino,
+// para que uma falha no meio da gravacao nao corrompa o arquivo anterior.
+// Formato: uma linha por jogador, "nome<TAB>pontos<TAB>vitorias<TAB>conquistas".
+// Retorna 1 em caso de sucesso e 0 em caso de erro.
+int placarSalvar(const char* caminho) {
+    PosicaoPlacar* posicoes = (PosicaoPlacar*)malloc(PLACAR_MAX_JOGADORES * sizeof(PosicaoPlacar));
+    if (posicoes == NULL) {
+        return 0;
+    }
+    int quantidade = placarConsultar(posicoes, PLACAR_MAX_JOGADORES);
+    
+    char temporario[300];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    FILE* arquivo = fopen(temporario, "w");
+    if (arquivo == NULL) {
+        free(posicoes);
+        return 0;
+    }
+    
+    for (int i = 0; i < quantidade; i++) {
+        fprintf(arquivo, "%s\t%ld\t%ld\t%ld\n",
+                posicoes[i].nome, posicoes[i].pontos,
+                posicoes[i].batalhasVencidas, posicoes[i].territoriosConquistados);
+    }
+    free(posicoes);
+    
+    if (fclose(arquivo) != 0) {
+        return 0;
+    }
+    return rename(temporario, caminho) == 0;
+}
+
+// placarCarregar():
+// Carrega um placar salvo anteriormente, somando seus valores ao placar atual.
+// Retorna o numero de jogadores lidos (0 se o arquivo nao existir).
+int placarCarregar(const char* caminho) {
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        return 0;
+    }
+    
+    char linha[MAX_NOME + 64];
+    int quantidade = 0;
+    while (fgets(linha, sizeof(linha), arquivo) != NULL) {
+        char* separador = strchr(linha, '\t');
+        long pontos, vencidas, conquistados;
+        if (separador == NULL || sscanf(separador + 1, "%ld %ld %ld", &pontos, &vencidas, &conquistados) != 3) {
+            continue;
+        }
+        *separador = '\0';
+        
+        placarSomar(placarRegistrarJogador(linha), pontos, vencidas, conquistados);
+        quantidade++;
+    }
+    fclose(arquivo);
+    return quantidade;
+}
+
+// executarPersistenciaPlacar():
+// Corpo da thread de persistencia: grava o placar a cada intervalo ate ser encerrada.
+static void* executarPersistenciaPlacar(void* argumento) {
+    PersistenciaPlacar* persistencia = (PersistenciaPlacar*)argumento;
+    
+    pthread_mutex_lock(&persistencia->trava);
+    while (!persistencia->encerrar) {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += persistencia->intervaloSegundos;
+        pthread_cond_timedwait(&persistencia->sinal, &persistencia->trava, &limite);
+        
+        if (!persistencia->encerrar) {
+            pthread_mutex_unlock(&persistencia->trava);
+            placarSalvar(persistencia->caminho);
+            pthread_mutex_lock(&persistencia->trava);
+        }
+    }
+    pthread_mutex_unlock(&persistencia->trava);
+    return NULL;
+}
+
+// placarIniciarPersistencia():
+// Inicia a thread que grava o placar periodicamente. A trava protege apenas o sinal de
+// encerramento; as atualizacoes do placar nunca passam por ela.
+// Retorna 1 se a thread foi iniciada.
+int placarIniciarPersistencia(const char* caminho, int intervaloSegundos) {
+    PersistenciaPlacar* persistencia = &persistenciaPlacar;
+    if (persistencia->ativa) {
+        return 1;
+    }
+    
+    strncpy(persistencia->caminho, caminho, sizeof(persistencia->caminho) - 1);
+    persistencia->intervaloSegundos = intervaloSegundos;
+    persistencia->encerrar = 0;
+    pthread_mutex_init(&persistencia->trava, NULL);
+    pthread_cond_init(&persistencia->sinal, NULL);
+    
+    if (pthread_create(&persistencia->thread, NULL, executarPersistenciaPlacar, persistencia) != 0) {
+        pthread_cond_destroy(&persistencia->sinal);
+        pthread_mutex_destroy(&persistencia->trava);
+        return 0;
+    }
+    persistencia->ativa = 1;
+    return 1;
+}
+
+// placarEncerrarPersistencia():
+// Encerra a thread de persistencia e faz uma ultima gravacao do placar.
+void placarEncerrarPersistencia(void) {
+    PersistenciaPlacar* persistencia = &persistenciaPlacar;
+    if (!persistencia->ativa) {
+        return;
+    }
+    
+    pthread_mutex_lock(&persistencia->trava);
+    persistencia->encerrar = 1;
+    pthread_cond_signal(&persistencia->sinal);
+    pthread_mutex_unlock(&persistencia->trava);
+    pthread_join(persistencia->thread, NULL);
+    
+    pthread_cond_destroy(&persistencia->sinal);
+    pthread_mutex_destroy(&persistencia->trava);
+    persistencia->ativa = 0;
+    
+    placarSalvar(persistencia->caminho);
+}
+
+// exportadorAbrir():
+// Cria o arquivo binario colunar (e o CSV, se informado) e grava o cabecalho:
+// "WARB", versao, marcador de ordem de bytes (0x01020304) e numero de colunas.
+// Retorna o exportador ou NULL em caso de erro.
+ExportadorBatalhas* exportadorAbrir(const char* caminhoBinario, const char* caminhoCsv) {
+    ExportadorBatalhas* exportador = (ExportadorBatalhas*)calloc(1, sizeof(ExportadorBatalhas));
+    if (exportador == NULL) {
+        return NULL;
+    }
+    
+    exportador->binario = fopen(caminhoBinario, "wb");
+    if (exportador->binario == NULL) {
+        free(exportador);
+        return NULL;
+    }
+    setvbuf(exportador->binario, NULL, _IOFBF, EXPORTACAO_BUFFER_ARQUIVO);
+    
+    unsigned int cabecalho[3] = {EXPORTACAO_VERSAO, 0x01020304u, (unsigned int)NUM_COLUNAS_BATALHA};
+    fwrite("WARB", 1, 4, exportador->binario);
+    fwrite(cabecalho, sizeof(unsigned int), 3, exportador->binario);
+    
+    if (caminhoCsv != NULL) {
+        exportador->csv = fopen(caminhoCsv, "w");
+        if (exportador->csv == NULL) {
+            fclose(exportador->binario);
+            free(exportador);
+            return NULL;
+        }
+        setvbuf(exportador->csv, NULL, _IOFBF, EXPORTACAO_BUFFER_ARQUIVO);
+        for (int c = 0; c < NUM_COLUNAS_BATALHA; c++) {
+            fprintf(exportador->csv, "%s%c", COLUNAS_BATALHA[c].nome, c + 1 < NUM_COLUNAS_BATALHA ? ',' : '\n');
+        }
+    }
+    return exportador;
+}
+
+// exportadorAtivarNaThread():
+// Define o exportador que recebe as batalhas resolvidas na thread atual (NULL desativa).
+void exportadorAtivarNaThread(ExportadorBatalhas* exportador) {
+    exportadorDaThread = exportador;
+}
+
+// exportadorRegistrar():
+// Acrescenta uma batalha ao bloco atual; apenas copia valores para as colunas.
+// O bloco e gravado quando enche.
+void exportadorRegistrar(ExportadorBatalhas* exportador, const Territorio* territorioOrigem,
+                         const Territorio* territorioDestino, int tropasAtaque, const ResultadoBatalha* resultado) {
+    ColunasBatalha* colunas = &exportador->colunas;
+    int i = exportador->linhas;
+    
+    colunas->poderAtacante[i] = (short)territorioOrigem->poder;
+    colunas->poderDefensor[i] = (short)territorioDestino->poder;
+    colunas->tropasAtaque[i] = (short)tropasAtaque;
+    colunas->tropasDefensor[i] = (short)territorioDestino->numTropas;
+    colunas->dadoAtacante[i] = (unsigned char)resultado->dadoAtacante;
+    colunas->dadoDefensor[i] = (unsigned char)resultado->dadoDefensor;
+    colunas->forcaAtacante[i] = (short)resultado->forcaAtacante;
+    colunas->forcaDefensor[i] = (short)resultado->forcaDefensor;
+    colunas->dano[i] = (short)resultado->dano;
+    colunas->conquistou[i] = (unsigned char)resultado->conquistou;
+    colunas->turno[i] = exportador->turnoAtual;
+    
+    if (++exportador->linhas == EXPORTACAO_LINHAS_BLOCO) {
+        exportadorDescarregar(exportador);
+    }
+}
+
+// exportadorRegistrarBlitz():
+// Acrescenta de uma vez as batalhas de um ataque relampago, na ordem sorteada por resolverBlitz()
+// (1 = vitoria), a partir dos territorios de antes do ataque. As tropas do defensor descontam as
+// vitorias anteriores e os dados de cada linha sao sorteados entre os pares que dao o resultado da rodada.
+void exportadorRegistrarBlitz(ExportadorBatalhas* exportador, const Territorio* territorioOrigem,
+                              const Territorio* territorioDestino, int tropasAtaque,
+                              const char* ordem, int rodadas, int conquistou) {
+    const ParametrosCombate* regras = regrasDaThread;
+    ColunasBatalha* colunas = &exportador->colunas;
+    int bonusAtacante = territorioOrigem->poder / regras->divisorPoder + tropasAtaque;
+    int bonusDefensor = territorioDestino->poder / regras->divisorPoder;
+    int tropasDefensor = territorioDestino->numTropas;
+    
+    for (int rodada = 0; rodada < rodadas; rodada++) {
+        unsigned char pares[36];
+        int combinacoes = 0;
+        for (int dados = 0; dados < 36; dados++) {
+            if ((dados / 6 + bonusAtacante > dados % 6 + bonusDefensor + tropasDefensor) == ordem[rodada]) {
+                pares[combinacoes++] = (unsigned char)dados;
+            }
+        }
+        int dados = pares[sortearInt(combinacoes)];
+        
+        int i = exportador->linhas;
+        colunas->poderAtacante[i] = (short)territorioOrigem->poder;
+        colunas->poderDefensor[i] = (short)territorioDestino->poder;
+        colunas->tropasAtaque[i] = (short)tropasAtaque;
+        colunas->tropasDefensor[i] = (short)tropasDefensor;
+        colunas->dadoAtacante[i] = (unsigned char)(dados / 6 + 1);
+        colunas->dadoDefensor[i] = (unsigned char)(dados % 6 + 1);
+        colunas->forcaAtacante[i] = (short)(dados / 6 + 1 + bonusAtacante);
+        colunas->forcaDefensor[i] = (short)(dados % 6 + 1 + bonusDefensor + tropasDefensor);
+        colunas->dano[i] = (short)(ordem[rodada] ? tropasAtaque * regras->danoPorTropa : 0);
+        colunas->conquistou[i] = (unsigned char)(conquistou && rodada == rodadas - 1);
+        colunas->turno[i] = exportador->turnoAtual;
+        if (++exportador->linhas == EXPORTACAO_LINHAS_BLOCO) {
+            exportadorDescarregar(exportador);
+        }
+        
+        if (ordem[rodada] && tropasDefensor > 1) tropasDefensor--;
+    }
+}
+
+// exportadorDescarregar():
+// Grava o bloco atual: numero de linhas seguido de cada coluna contigua. Se houver CSV,
+// as mesmas linhas sao acrescentadas a ele. Retorna 1 em caso de sucesso.
+int exportadorDescarregar(ExportadorBatalhas* exportador) {
+    int linhas = exportador->linhas;
+    if (linhas == 0) {
+        return 1;
+    }
+    
+    const char* base = (const char*)&exportador->colunas;
+    unsigned int cabecalhoBloco = (unsigned int)linhas;
+    int ok = fwrite(&cabecalhoBloco, sizeof(cabecalhoBloco), 1, exportador->binario) == 1;
+    for (int c = 0; c < NUM_COLUNAS_BATALHA && ok; c++) {
+        ok = fwrite(base + COLUNAS_BATALHA[c].deslocamento, COLUNAS_BATALHA[c].largura,
+                    (size_t)linhas, exportador->binario) == (size_t)linhas;
+    }
+    
+    if (exportador->csv != NULL) {
+        const ColunasBatalha* colunas = &exportador->colunas;
+        for (int i = 0; i < linhas; i++) {
+            fprintf(exportador->csv, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+                    colunas->poderAtacante[i], colunas->poderDefensor[i],
+                    colunas->tropasAtaque[i], colunas->tropasDefensor[i],
+                    colunas->dadoAtacante[i], colunas->dadoDefensor[i],
+                    colunas->forcaAtacante[i], colunas->forcaDefensor[i],
+                    colunas->dano[i], colunas->conquistou[i], colunas->turno[i]);
+        }
+    }
+    
+    exportador->totalLinhas += linhas;
+    exportador->linhas = 0;
+    return ok;
+}
+
+// exportadorFechar():
+// Grava o bloco pendente, fecha os arquivos e libera o exportador.
+// Retorna 1 se todos os dados foram gravados.
+int exportadorFechar(ExportadorBatalhas* exportador) {
+    int ok = exportadorDescarregar(exportador);
+    ok = (fclose(exportador->binario) == 0) && ok;
+    if (exportador->csv != NULL) {
+        ok = (fclose(exportador->csv) == 0) && ok;
+    }
+    free(exportador);
+    return ok;
+}
+
+// lerResumoBatalhas():
+// Le um arquivo exportado bloco a bloco e calcula os agregados.
+// Retorna 1 em caso de sucesso e 0 se o arquivo nao existir ou estiver em formato diferente.
+int lerResumoBatalhas(const char* caminho, ResumoBatalhas* resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return 0;
+    }
+    
+    char magico[4];
+    unsigned int cabecalho[3];
+    if (fread(magico, 1, 4, arquivo) != 4 || memcmp(magico, "WARB", 4) != 0 ||
+        fread(cabecalho, sizeof(unsigned int), 3, arquivo) != 3 ||
+        cabecalho[0] != EXPORTACAO_VERSAO || cabecalho[1] != 0x01020304u ||
+        cabecalho[2] != (unsigned int)NUM_COLUNAS_BATALHA) {
+        fclose(arquivo);
+        return 0;
+    }
+    
+    ColunasBatalha* colunas = (ColunasBatalha*)malloc(sizeof(ColunasBatalha));
+    if (colunas == NULL) {
+        fclose(arquivo);
+        return 0;
+    }
+    
+    int ok = 1;
+    unsigned int linhas;
+    while (ok && fread(&linhas, sizeof(linhas), 1, arquivo) == 1) {
+        if (linhas > EXPORTACAO_LINHAS_BLOCO) {
+            ok = 0;
+            break;
+        }
+        
+        char* base = (char*)colunas;
+        for (int c = 0; c < NUM_COLUNAS_BATALHA && ok; c++) {
+            ok = fread(base + COLUNAS_BATALHA[c].deslocamento, COLUNAS_BATALHA[c].largura, linhas, arquivo) == linhas;
+        }
+        
+        // Cada agregado percorre uma unica coluna
+        for (unsigned int i = 0; ok && i < linhas; i++) {
+            resumo->vitoriasAtacante += colunas->forcaAtacante[i] > colunas->forcaDefensor[i];
+            resumo->somaForcaAtacante += colunas->forcaAtacante[i];
+            resumo->somaForcaDefensor += colunas->forcaDefensor[i];
+        }
+        for (unsigned int i = 0; ok && i < linhas; i++) resumo->conquistas += colunas->conquistou[i];
+        for (unsigned int i = 0; ok && i < linhas; i++) resumo->somaDano += colunas->dano[i];
+        for (unsigned int i = 0; ok && i < linhas; i++) resumo->somaTropasAtaque += colunas->tropasAtaque[i];
+        if (ok && linhas > 0) resumo->ultimoTurno = colunas->turno[linhas - 1];
+        
+        if (ok) resumo->batalhas += linhas;
+    }
+    
+    free(colunas);
+    fclose(arquivo);
+    return ok;
+}
+
+// exibirResumoBatalhas():
+// Exibe os agregados calculados por lerResumoBatalhas().
+void exibirResumoBatalhas(const ResumoBatalhas* resumo) {
+    double total = resumo->batalhas > 0 ? (double)resumo->batalhas : 1.0;
+    double vitorias = resumo->vitoriasAtacante > 0 ? (double)resumo->vitoriasAtacante : 1.0;
+    
+    printf("\n=== RESUMO DAS BATALHAS ===\n");
+    printf("Batalhas: %ld\n", resumo->batalhas);
+    printf("Vitorias do atacante: %ld (%.1f%%)\n", resumo->vitoriasAtacante, resumo->vitoriasAtacante * 100.0 / total);
+    printf("Conquistas: %ld (%.1f%%)\n", resumo->conquistas, resumo->conquistas * 100.0 / total);
+    printf("Dano medio por vitoria: %.1f\n", resumo->somaDano / vitorias);
+    printf("Forca media: atacante %.2f | defensor %.2f\n",
+           resumo->somaForcaAtacante / total, resumo->somaForcaDefensor / total);
+    printf("Tropas medias por ataque: %.2f\n", resumo->somaTropasAtaque / total);
+    printf("Ultimo turno registrado: %d\n", resumo->ultimoTurno);
+    printf("===========================\n");
+}
+
+// lerOpcoesExecucao():
+// Interpreta os argumentos da linha de comando:
+//   --exportar-batalhas <arquivo>  grava cada batalha do jogo interativo no formato colunar
+//   --csv <arquivo>                grava tambem um CSV (junto com --exportar-batalhas)
+//   --resumo-batalhas <arquivo>    exibe os agregados de um arquivo exportado e sai
+//   --varredura <arquivo.csv>      executa a varredura de parametros e grava as taxas de vitoria
+//   --threads <N>, --partidas <N>  threads e partidas por ponto da varredura
+//   --autojogo <prefixo>           joga --partidas partidas automaticas e grava as decisoes em
+//                                  <prefixo>.<thread>.bin (com --threads e --politica gulosa|aleatoria)
+//   --gerar-inicios <arquivo>      grava --inicios mapas iniciais equilibrados (diferenca entre as
+//                                  cores de ate --equilibrio % da forca media) e sai
+//   --inicio <arquivo> <indice>    comeca o jogo pelo mapa gravado na posicao <indice> (a partir de 0)
+//   --transmitir <nome>            publica o jogo na memoria compartilhada <nome> para espectadores
+//   --espectador <nome>            acompanha o jogo publicado em <nome> e sai quando ele terminar
+//   --bench-influencia <N>         mede o mapa de influencia em uma grade de N territorios, conferindo
+//                                  as atualizacoes incrementais contra uma reconstrucao completa, e sai
+//   --verificar-final <N>          a opcao 7 tambem confere a chance exata jogando N partidas simuladas
+// Retorna 0 (e exibe o uso) se algum argumento for invalido.
+int lerOpcoesExecucao(int argc, char* argv[], OpcoesExecucao* opcoes) {
+    memset(opcoes, 0, sizeof(*opcoes));
+    
+    opcoes->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    opcoes->partidas = VARREDURA_PARTIDAS;
+    opcoes->inicios = INICIOS_PADRAO;
+    opcoes->equilibrio = INICIOS_EQUILIBRIO_PADRAO;
+    
+    for (int i = 1; i < argc; i++) {
+        const char** destino = NULL;
+        int* numero = NULL;
+        
+        // --inicio recebe dois valores: arquivo e indice
+        if (strcmp(argv[i], "--inicio") == 0 && i + 2 < argc) {
+            char* fim;
+            opcoes->inicio = argv[i + 1];
+            opcoes->indiceInicio = (int)strtol(argv[i + 2], &fim, 10);
+            if (*fim != '\0' || opcoes->indiceInicio < 0) {
+                printf("--inicio precisa de um indice a partir de 0.\n");
+                return 0;
+            }
+            i += 2;
+            continue;
+        }
+        
+        if (strcmp(argv[i], "--exportar-batalhas") == 0) destino = &opcoes->exportarBatalhas;
+        else if (strcmp(argv[i], "--csv") == 0) destino = &opcoes->exportarCsv;
+        else if (strcmp(argv[i], "--resumo-batalhas") == 0) destino = &opcoes->resumoBatalhas;
+        else if (strcmp(argv[i], "--varredura") == 0) destino = &opcoes->varredura;
+        else if (strcmp(argv[i], "--transmitir") == 0) destino = &opcoes->transmitir;
+        else if (strcmp(argv[i], "--espectador") == 0) destino = &opcoes->espectador;
+        else if (strcmp(argv[i], "--autojogo") == 0) destino = &opcoes->autojogo;
+        else if (strcmp(argv[i], "--politica") == 0) destino = &opcoes->politica;
+        else if (strcmp(argv[i], "--gerar-inicios") == 0) destino = &opcoes->gerarInicios;
+        else if (strcmp(argv[i], "--bench-influencia") == 0) numero = &opcoes->benchInfluencia;
+        else if (strcmp(argv[i], "--verificar-final") == 0) numero = &opcoes->verificarFinal;
+        else if (strcmp(argv[i], "--inicios") == 0) numero = &opcoes->inicios;
+        else if (strcmp(argv[i], "--equilibrio") == 0) numero = &opcoes->equilibrio;
+        else if (strcmp(argv[i], "--threads") == 0) numero = &opcoes->threads;
+        else if (strcmp(argv[i], "--partidas") == 0) numero = &opcoes->partidas;
+        
+        if ((destino == NULL && numero == NULL) || i + 1 >= argc) {
+            printf("Uso: %s [--exportar-batalhas arquivo [--csv arquivo]] [--resumo-batalhas arquivo]\n", argv[0]);
+            printf("       [--varredura arquivo.csv [--threads N] [--partidas N]]\n");
+            printf("       [--transmitir nome] [--espectador nome] [--bench-influencia N] [--verificar-final N]\n");
+            printf("       [--autojogo prefixo [--politica gulosa|aleatoria] [--threads N] [--partidas N]]\n");
+            printf("       [--gerar-inicios arquivo [--inicios N] [--equilibrio P] [--threads N]] [--inicio arquivo indice]\n");
+            return 0;
+        }
+        
+        if (destino != NULL) {
+            *destino = argv[++i];
+        } else {
+            *numero = atoi(argv[++i]);
+            if (*numero < 1) {
+                printf("%s precisa de um numero positivo.\n", argv[i - 1]);
+                return 0;
+            }
+        }
+    }
+    
+    if (opcoes->threads < 1) opcoes->threads = 1;
+    
+    if (opcoes->exportarCsv != NULL && opcoes->exportarBatalhas == NULL) {
+        printf("--csv precisa ser usado junto com --exportar-batalhas.\n");
+        return 0;
+    }
+    return 1;
+}
+
+// semearAleatorio():
+// Define a semente do gerador pseudoaleatorio da thread atual.
+void semearAleatorio(unsigned long long semente) {
+    // splitmix64 espalha sementes parecidas (ex.: horarios) e garante estado diferente de zero
+    semente += 0x9E3779B97F4A7C15ULL;
+    semente = (semente ^ (semente >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    semente = (semente ^ (semente >> 27)) * 0x94D049BB133111EBULL;
+    semente ^= semente >> 31;
+    estadoAleatorio = semente != 0 ? semente : 0x9E3779B97F4A7C15ULL;
+}
+
+// sortearInt():
+// Retorna um inteiro de 0 a limite-1 usando o gerador da thread atual.
+int sortearInt(int limite) {
+    estadoAleatorio ^= estadoAleatorio >> 12;
+    estadoAleatorio ^= estadoAleatorio << 25;
+    estadoAleatorio ^= estadoAleatorio >> 27;
+    unsigned long long valor = estadoAleatorio * 0x2545F4914F6CDD1DULL;
+    return (int)(((valor >> 32) * (unsigned long long)limite) >> 32);
+}
+
+// definirRegrasNaThread():
+// Define as constantes de combate usadas por resolverAtaque() na thread atual (NULL volta ao padrao).
+void definirRegrasNaThread(const ParametrosCombate* regras) {
+    regrasDaThread = (regras != NULL) ? regras : &REGRAS_PADRAO;
+}
+
+// alvoDaMissao():
+// Retorna 1 se conquistar o territorio aproxima o jogador da missao: territorio da cor a destruir,
+// de um continente exigido ou, em missoes de quantidade, qualquer territorio.
+int alvoDaMissao(const MissaoCompilada* missao, const Territorio* territorio, int indice) {
+    const unsigned char* pc = missao->codigo;
+    
+    for (;;) {
+        switch (pc[0]) {
+            case OP_FIM:
+                return 0;
+            case OP_SEM_COR:
+                if (strcmp(territorio->corExercito, NOMES_CORES[pc[1]]) == 0) return 1;
+                pc += 2;
+                break;
+            case OP_POSSUI:
+                return 1;
+            case OP_POSSUI_COM_TROPAS:
+                return 1;
+            case OP_CONTINENTE:
+                if (continenteDoTerritorio(indice) == pc[1]) return 1;
+                pc += 2;
+                break;
+            default:
+                return 0;
+        }
+    }
+}
+
+// escolherAtaqueAutomatico():
+// Politica gulosa usada nas simulacoes: ataca a partir do territorio proprio com mais tropas,
+// contra o inimigo de menor resistencia, dando prioridade aos alvos da missao.
+// Retorna 0 se nao houver ataque possivel.
+int escolherAtaqueAutomatico(const Territorio* mapa, const Jogador* jogador, int idMissao,
+                             int* origem, int* destino, int* tropas) {
+    const MissaoCompilada* missao = (idMissao >= 1 && idMissao <= catalogoMissoes.quantidade) ?
+                                    &catalogoMissoes.missoes[idMissao - 1] : NULL;
+    int melhorOrigem = -1;
+    int melhorDestino = -1;
+    int menorResistencia = 0;
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (strcmp(mapa[i].corExercito, jogador->cor) == 0) {
+            if (mapa[i].numTropas > 1 && (melhorOrigem < 0 || mapa[i].numTropas > mapa[melhorOrigem].numTropas)) {
+                melhorOrigem = i;
+            }
+        } else {
+            int resistencia = mapa[i].numTropas + mapa[i].vida / 100;
+            if (missao != NULL && !alvoDaMissao(missao, &mapa[i], i)) {
+                resistencia += 1000; // Alvos fora da missao so quando nao houver outro
+            }
+            if (melhorDestino < 0 || resistencia < menorResistencia) {
+                melhorDestino = i;
+                menorResistencia = resistencia;
+            }
+        }
+    }
+    
+    if (melhorOrigem < 0 || melhorDestino < 0) {
+        return 0;
+    }
+    
+    *origem = melhorOrigem;
+    *destino = melhorDestino;
+    *tropas = mapa[melhorOrigem].numTropas - 1;
+    if (*tropas > MAX_TROPAS_ATAQUE) *tropas = MAX_TROPAS_ATAQUE;
+    return 1;
+}
+
+// jogarPartidaSimulada():
+// Joga uma partida sem interface com a politica automatica, usando as regras e o gerador
+// da thread atual. O jogador recebe cor e pais sorteados e a alocacao de vida informada.
+// Retorna 1 se a missao foi cumprida em ate maxTurnos ataques.
+int jogarPartidaSimulada(int vidaJogador, int idMissao, int maxTurnos) {
+    Territorio mapa[NUM_TERRITORIOS];
+    Jogador jogador = {0};
+    
+    inicializarTerritorios(mapa, NULL);
+    strcpy(jogador.nome, "Simulado");
+    strcpy(jogador.cor, NOMES_CORES[sortearInt(NUM_CORES)]);
+    strcpy(jogador.paisOrigem, mapa[sortearInt(NUM_TERRITORIOS)].nome);
+    jogador.vida = vidaJogador;
+    jogador.poder = MAX_VIDA - vidaJogador;
+    jogador.pontos = 100;
+    inicializarTerritorios(mapa, &jogador);
+    
+    return simularAteFim(mapa, &jogador, idMissao, maxTurnos);
+}
+
+// simularAteFim():
+// Continua uma partida a partir do mapa informado, atacando com a politica automatica.
+// Retorna 1 se a missao for cumprida em ate maxTurnos ataques.
+int simularAteFim(Territorio* mapa, Jogador* jogador, int idMissao, int maxTurnos) {
+    for (int turno = 0; turno < maxTurnos; turno++) {
+        if (verificarVitoria(mapa, idMissao, jogador->cor)) {
+            return 1;
+        }
+        
+        int origem, destino, tropas;
+        if (!escolherAtaqueAutomatico(mapa, jogador, idMissao, &origem, &destino, &tropas)) {
+            return 0;
+        }
+        resolverAtaque(&mapa[origem], &mapa[destino], jogador, tropas);
+    }
+    return verificarVitoria(mapa, idMissao, jogador->cor);
+}
+
+// hashPontoVarredura():
+// Hash FNV-1a de tudo que determina o resultado de um ponto: parametros, bytecode da missao,
+// partidas e limite de turnos. Tambem serve de semente, tornando cada ponto reproduzivel.
+static unsigned long long hashPontoVarredura(const PontoVarredura* ponto, int maxTurnos) {
+    int valores[6] = {ponto->vida, ponto->regras.divisorPoder, ponto->regras.danoPorTropa,
+                      ponto->regras.divisorConquista, ponto->partidas, maxTurnos};
+    const MissaoCompilada* missao = &catalogoMissoes.missoes[ponto->idMissao - 1];
+    unsigned long long hash = 14695981039346656037ULL;
+    
+    const unsigned char* bytes = (const unsigned char*)valores;
+    for (size_t i = 0; i < sizeof(valores); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    for (int i = 0; i < missao->tamanho; i++) {
+        hash = (hash ^ missao->codigo[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// compararCacheVarredura():
+// Ordena as entradas do cache por hash, para busca binaria.
+static int compararCacheVarredura(const void* a, const void* b) {
+    unsigned long long ha = ((const EntradaCacheVarredura*)a)->hash;
+    unsigned long long hb = ((const EntradaCacheVarredura*)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+// executarTrabalhoVarredura():
+// Corpo das threads da varredura: pega o proximo ponto pendente e joga suas partidas.
+static void* executarTrabalhoVarredura(void* argumento) {
+    TrabalhoVarredura* trabalho = (TrabalhoVarredura*)argumento;
+    int i;
+    
+    while ((i = atomic_fetch_add(&trabalho->proximo, 1)) < trabalho->quantidade) {
+        PontoVarredura* ponto = &trabalho->pontos[i];
+        if (ponto->emCache) {
+            continue;
+        }
+        
+        semearAleatorio(ponto->hash); // Semente pelo hash: o resultado do ponto nao depende da thread
+        definirRegrasNaThread(&ponto->regras);
+        ponto->vitorias = 0;
+        for (int p = 0; p < ponto->partidas; p++) {
+            ponto->vitorias += jogarPartidaSimulada(ponto->vida, ponto->idMissao, trabalho->maxTurnos);
+        }
+    }
+    definirRegrasNaThread(NULL);
+    return NULL;
+}
+
+// executarVarredura():
+// Simula a grade de alocacoes de vida/poder e constantes de combate para cada missao do catalogo,
+// distribuindo os pontos entre threads. Pontos ja presentes no cache nao sao simulados de novo.
+// Grava as taxas de vitoria em CSV e exibe a melhor configuracao por missao.
+// Retorna 1 em caso de sucesso.
+int executarVarredura(const char* caminhoSaida, int numThreads, int partidas) {
+    int numDivisores = (int)(sizeof(VARREDURA_DIVISORES_PODER) / sizeof(int));
+    int numDanos = (int)(sizeof(VARREDURA_DANOS_POR_TROPA) / sizeof(int));
+    int numConquistas = (int)(sizeof(VARREDURA_DIVISORES_CONQUISTA) / sizeof(int));
+    int numVidas = MAX_VIDA / VARREDURA_PASSO_VIDA + 1;
+    int quantidade = catalogoMissoes.quantidade * numVidas * numDivisores * numDanos * numConquistas;
+    
+    TrabalhoVarredura trabalho;
+    trabalho.pontos = (PontoVarredura*)calloc((size_t)quantidade, sizeof(PontoVarredura));
+    trabalho.quantidade = quantidade;
+    trabalho.maxTurnos = SIMULACAO_MAX_TURNOS;
+    atomic_init(&trabalho.proximo, 0);
+    if (trabalho.pontos == NULL) {
+        printf("Erro: Nao foi possivel alocar memoria para a varredura!\n");
+        return 0;
+    }
+    
+    // Monta a grade
+    int n = 0;
+    for (int m = 1; m <= catalogoMissoes.quantidade; m++)
+    for (int v = 0; v < numVidas; v++)
+    for (int d = 0; d < numDivisores; d++)
+    for (int t = 0; t < numDanos; t++)
+    for (int c = 0; c < numConquistas; c++) {
+        PontoVarredura* ponto = &trabalho.pontos[n++];
+        ponto->idMissao = m;
+        ponto->vida = v * VARREDURA_PASSO_VIDA;
+        ponto->regras.divisorPoder = VARREDURA_DIVISORES_PODER[d];
+        ponto->regras.danoPorTropa = VARREDURA_DANOS_POR_TROPA[t];
+        ponto->regras.divisorConquista = VARREDURA_DIVISORES_CONQUISTA[c];
+        ponto->partidas = partidas;
+        ponto->hash = hashPontoVarredura(ponto, trabalho.maxTurnos);
+    }
+    
+    // Aproveita os resultados do cache
+    EntradaCacheVarredura* cache = NULL;
+    int tamanhoCache = 0, capacidadeCache = 0, reaproveitados = 0;
+    FILE* arquivoCache = fopen(VARREDURA_CACHE, "r");
+    if (arquivoCache != NULL) {
+        EntradaCacheVarredura entrada;
+        while (fscanf(arquivoCache, "%llx %d %d", &entrada.hash, &entrada.partidas, &entrada.vitorias) == 3) {
+            if (tamanhoCache == capacidadeCache) {
+                capacidadeCache = capacidadeCache ? capacidadeCache * 2 : 1024;
+                EntradaCacheVarredura* maior = (EntradaCacheVarredura*)realloc(cache, capacidadeCache * sizeof(*cache));
+                if (maior == NULL) break;
+                cache = maior;
+            }
+            cache[tamanhoCache++] = entrada;
+        }
+        fclose(arquivoCache);
+        qsort(cache, (size_t)tamanhoCache, sizeof(*cache), compararCacheVarredura);
+    }
+    for (int i = 0; i < quantidade && tamanhoCache > 0; i++) {
+        EntradaCacheVarredura chave = {trabalho.pontos[i].hash, 0, 0};
+        const EntradaCacheVarredura* achado = (const EntradaCacheVarredura*)bsearch(
+            &chave, cache, (size_t)tamanhoCache, sizeof(*cache), compararCacheVarredura);
+        if (achado != NULL) {
+            trabalho.pontos[i].vitorias = achado->vitorias;
+            trabalho.pontos[i].emCache = 1;
+            reaproveitados++;
+        }
+    }
+    free(cache);
+    
+    printf("Varredura: %d pontos x %d partidas (%d em cache), %d threads...\n",
+           quantidade, partidas, reaproveitados, numThreads);
+    
+    // Simula os pontos pendentes em paralelo
+    pthread_t* threads = (pthread_t*)malloc((size_t)numThreads * sizeof(pthread_t));
+    int iniciadas = 0;
+    while (threads != NULL && iniciadas < numThreads &&
+           pthread_create(&threads[iniciadas], NULL, executarTrabalhoVarredura, &trabalho) == 0) {
+        iniciadas++;
+    }
+    if (iniciadas == 0) {
+        executarTrabalhoVarredura(&trabalho);
+    }
+    for (int i = 0; i < iniciadas; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    
+    // Acrescenta os novos resultados ao cache
+    arquivoCache = fopen(VARREDURA_CACHE, "a");
+    if (arquivoCache != NULL) {
+        for (int i = 0; i < quantidade; i++) {
+            if (!trabalho.pontos[i].emCache) {
+                fprintf(arquivoCache, "%llx %d %d\n", trabalho.pontos[i].hash,
+                        trabalho.pontos[i].partidas, trabalho.pontos[i].vitorias);
+            }
+        }
+        fclose(arquivoCache);
+    }
+    
+    // Grava as superficies de taxa de vitoria
+    FILE* saida = fopen(caminhoSaida, "w");
+    if (saida == NULL) {
+        printf("Erro: Nao foi possivel criar o arquivo %s!\n", caminhoSaida);
+        free(trabalho.pontos);
+        return 0;
+    }
+    fprintf(saida, "missao,vida,poder,divisorPoder,danoPorTropa,divisorConquista,partidas,vitorias,taxaVitoria\n");
+    for (int i = 0; i < quantidade; i++) {
+        const PontoVarredura* ponto = &trabalho.pontos[i];
+        fprintf(saida, "%d,%d,%d,%d,%d,%d,%d,%d,%.4f\n",
+                ponto->idMissao, ponto->vida, MAX_VIDA - ponto->vida,
+                ponto->regras.divisorPoder, ponto->regras.danoPorTropa, ponto->regras.divisorConquista,
+                ponto->partidas, ponto->vitorias, (double)ponto->vitorias / ponto->partidas);
+    }
+    fclose(saida);
+    
+    // Resumo: melhor ponto de cada missao
+    printf("\n=== MELHOR CONFIGURACAO POR MISSAO ===\n");
+    int porMissao = quantidade / catalogoMissoes.quantidade;
+    for (int m = 0; m < catalogoMissoes.quantidade; m++) {
+        const PontoVarredura* melhor = &trabalho.pontos[m * porMissao];
+        for (int i = 1; i < porMissao; i++) {
+            if (trabalho.pontos[m * porMissao + i].vitorias > melhor->vitorias) {
+                melhor = &trabalho.pontos[m * porMissao + i];
+            }
+        }
+        printf("Missao %d: %.1f%% (vida %d, poder %d, divisor de poder %d, dano/tropa %d, divisor de conquista %d)\n",
+               m + 1, 100.0 * melhor->vitorias / melhor->partidas, melhor->vida, MAX_VIDA - melhor->vida,
+               melhor->regras.divisorPoder, melhor->regras.danoPorTropa, melhor->regras.divisorConquista);
+    }
+    printf("Resultados gravados em %s\n", caminhoSaida);
+    
+    free(trabalho.pontos);
+    return 1;
+}
+
+// grafoCriar():
+// Monta o grafo em formato CSR a partir de uma lista de arestas nao direcionadas.
+// Retorna 1 em caso de sucesso ou 0 se faltar memoria.
+int grafoCriar(GrafoTerritorios* grafo, int numTerritorios, const int (*arestas)[2], int numArestas) {
+    grafo->numTerritorios = numTerritorios;
+    grafo->inicio = (int*)calloc((size_t)numTerritorios + 1, sizeof(int));
+    grafo->vizinhos = (int*)malloc((2 * (size_t)numArestas + 1) * sizeof(int));
+    if (grafo->inicio == NULL || grafo->vizinhos == NULL) {
+        grafoLiberar(grafo);
+        return 0;
+    }
+    
+    // Conta o grau de cada territorio e acumula para obter o inicio de cada lista
+    for (int a = 0; a < numArestas; a++) {
+        grafo->inicio[arestas[a][0] + 1]++;
+        grafo->inicio[arestas[a][1] + 1]++;
+    }
+    for (int t = 0; t < numTerritorios; t++) {
+        grafo->inicio[t + 1] += grafo->inicio[t];
+    }
+    
+    // Preenche as listas usando 'inicio' como cursor e depois o restaura
+    for (int a = 0; a < numArestas; a++) {
+        grafo->vizinhos[grafo->inicio[arestas[a][0]]++] = arestas[a][1];
+        grafo->vizinhos[grafo->inicio[arestas[a][1]]++] = arestas[a][0];
+    }
+    for (int t = numTerritorios; t > 0; t--) {
+        grafo->inicio[t] = grafo->inicio[t - 1];
+    }
+    grafo->inicio[0] = 0;
+    return 1;
+}
+
+// grafoLiberar():
+// Libera as listas do grafo.
+void grafoLiberar(GrafoTerritorios* grafo) {
+    free(grafo->inicio);
+    free(grafo->vizinhos);
+    grafo->inicio = NULL;
+    grafo->vizinhos = NULL;
+}
+
+// forcaTerritorio():
+// Forca de um territorio, na mesma escala usada para a ameaca por cor: tropas + (vida + poder) / 100.
+int forcaTerritorio(const Territorio* territorio) {
+    return territorio->numTropas + (territorio->vida + territorio->poder) / 100;
+}
+
+// corInfluencia():
+// Indice da cor no mapa de influencia; cores fora da tabela usam a ultima posicao.
+int corInfluencia(const char* cor) {
+    int indice = indiceCor(cor);
+    return indice >= 0 ? indice : NUM_CORES;
+}
+
+// espalharInfluencia():
+// Busca em largura a partir do territorio ate INFLUENCIA_RAIO, somando forca * peso da distancia
+// a influencia da cor em cada territorio alcancado. Com forca negativa, remove a contribuicao.
+// Custa apenas o tamanho da vizinhanca, independente do tamanho do mapa.
+static void espalharInfluencia(MapaInfluencia* mapaInfluencia, int origem, int cor, long forca) {
+    const GrafoTerritorios* grafo = mapaInfluencia->grafo;
+    int* fila = mapaInfluencia->fila;
+    int carimbo = ++mapaInfluencia->carimbo;
+    int inicioNivel = 0, fimFila = 0;
+    
+    fila[fimFila++] = origem;
+    mapaInfluencia->marca[origem] = carimbo;
+    
+    for (int distancia = 0; distancia <= INFLUENCIA_RAIO && inicioNivel < fimFila; distancia++) {
+        int fimNivel = fimFila;
+        long contribuicao = forca * (INFLUENCIA_ESCALA >> distancia);
+        
+        for (int i = inicioNivel; i < fimNivel; i++) {
+            int t = fila[i];
+            mapaInfluencia->influencia[(long)t * INFLUENCIA_CORES + cor] += contribuicao;
+            
+            if (distancia == INFLUENCIA_RAIO) continue;
+            for (int v = grafo->inicio[t]; v < grafo->inicio[t + 1]; v++) {
+                int vizinho = grafo->vizinhos[v];
+                if (mapaInfluencia->marca[vizinho] != carimbo) {
+                    mapaInfluencia->marca[vizinho] = carimbo;
+                    fila[fimFila++] = vizinho;
+                }
+            }
+        }
+        inicioNivel = fimNivel;
+    }
+}
+
+// influenciaCriar():
+// Aloca o mapa de influencia e espalha a forca inicial de todos os territorios.
+// Retorna 1 em caso de sucesso ou 0 se faltar memoria.
+int influenciaCriar(MapaInfluencia* mapaInfluencia, const GrafoTerritorios* grafo, const Territorio* mapa) {
+    size_t n = (size_t)grafo->numTerritorios;
+    
+    mapaInfluencia->grafo = grafo;
+    mapaInfluencia->carimbo = 0;
+    mapaInfluencia->influencia = (long*)calloc(n * INFLUENCIA_CORES, sizeof(long));
+    mapaInfluencia->dono = (signed char*)malloc(n);
+    mapaInfluencia->forca = (int*)malloc(n * sizeof(int));
+    mapaInfluencia->marca = (int*)calloc(n, sizeof(int));
+    mapaInfluencia->fila = (int*)malloc(n * sizeof(int));
+    if (mapaInfluencia->influencia == NULL || mapaInfluencia->dono == NULL || mapaInfluencia->forca == NULL ||
+        mapaInfluencia->marca == NULL || mapaInfluencia->fila == NULL) {
+        influenciaLiberar(mapaInfluencia);
+        return 0;
+    }
+    
+    for (size_t t = 0; t < n; t++) {
+        mapaInfluencia->dono[t] = (signed char)corInfluencia(mapa[t].corExercito);
+        mapaInfluencia->forca[t] = forcaTerritorio(&mapa[t]);
+        espalharInfluencia(mapaInfluencia, (int)t, mapaInfluencia->dono[t], mapaInfluencia->forca[t]);
+    }
+    return 1;
+}
+
+// influenciaLiberar():
+// Libera a memoria do mapa de influencia.
+void influenciaLiberar(MapaInfluencia* mapaInfluencia) {
+    free(mapaInfluencia->influencia);
+    free(mapaInfluencia->dono);
+    free(mapaInfluencia->forca);
+    free(mapaInfluencia->marca);
+    free(mapaInfluencia->fila);
+    mapaInfluencia->influencia = NULL;
+    mapaInfluencia->dono = NULL;
+    mapaInfluencia->forca = NULL;
+    mapaInfluencia->marca = NULL;
+    mapaInfluencia->fila = NULL;
+}
+
+// influenciaAtualizar():
+// Troca a cor e a forca de um territorio: remove a contribuicao antiga e espalha a nova,
+// tocando apenas a vizinhanca ate INFLUENCIA_RAIO.
+void influenciaAtualizar(MapaInfluencia* mapaInfluencia, int territorio, int cor, int forca) {
+    int corAntiga = mapaInfluencia->dono[territorio];
+    int forcaAntiga = mapaInfluencia->forca[territorio];
+    if (cor == corAntiga && forca == forcaAntiga) {
+        return;
+    }
+    
+    espalharInfluencia(mapaInfluencia, territorio, corAntiga, -forcaAntiga);
+    espalharInfluencia(mapaInfluencia, territorio, cor, forca);
+    mapaInfluencia->dono[territorio] = (signed char)cor;
+    mapaInfluencia->forca[territorio] = forca;
+}
+
+// influenciaSincronizar():
+// Atualiza o mapa de influencia com o estado atual de um territorio do mapa.
+void influenciaSincronizar(MapaInfluencia* mapaInfluencia, const Territorio* mapa, int territorio) {
+    influenciaAtualizar(mapaInfluencia, territorio, corInfluencia(mapa[territorio].corExercito),
+                        forcaTerritorio(&mapa[territorio]));
+}
+
+// influenciaDaCor():
+// Influencia da cor sobre o territorio, na escala de forcaTerritorio().
+double influenciaDaCor(const MapaInfluencia* mapaInfluencia, int territorio, int cor) {
+    return (double)mapaInfluencia->influencia[(long)territorio * INFLUENCIA_CORES + cor] / INFLUENCIA_ESCALA;
+}
+
+// influenciaAmeaca():
+// Ameaca sobre o territorio: soma da influencia de todas as cores exceto a do seu dono.
+double influenciaAmeaca(const MapaInfluencia* mapaInfluencia, int territorio) {
+    const long* valores = &mapaInfluencia->influencia[(long)territorio * INFLUENCIA_CORES];
+    long total = 0;
+    for (int c = 0; c < INFLUENCIA_CORES; c++) {
+        if (c != mapaInfluencia->dono[territorio]) {
+            total += valores[c];
+        }
+    }
+    return (double)total / INFLUENCIA_ESCALA;
+}
+
+// executarBancadaInfluencia():
+// Gera uma grade de numTerritorios territorios (cada um ligado ao vizinho da direita e ao de baixo)
+// com donos e forcas sorteados e aplica numTerritorios mudancas aleatorias com influenciaAtualizar().
+// Em seguida reconstroi o mapa do zero com influenciaCriar() e compara os dois valor a valor.
+// Exibe os tempos e retorna 1 se o mapa incremental for identico a reconstrucao.
+int executarBancadaInfluencia(int numTerritorios) {
+    int lado = 1;
+    while ((long)lado * lado < numTerritorios) lado++;
+    
+    Territorio* mapa = (Territorio*)calloc((size_t)numTerritorios, sizeof(Territorio));
+    int (*arestas)[2] = (int (*)[2])malloc(2 * (size_t)numTerritorios * sizeof(*arestas));
+    if (mapa == NULL || arestas == NULL) {
+        printf("Erro: Nao foi possivel alocar memoria para a grade!\n");
+        free(mapa);
+        free(arestas);
+        return 0;
+    }
+    
+    // Grade: cada territorio faz fronteira com o da direita e o de baixo
+    int numArestas = 0;
+    for (int t = 0; t < numTerritorios; t++) {
+        if ((t + 1) % lado != 0 && t + 1 < numTerritorios) {
+            arestas[numArestas][0] = t;
+            arestas[numArestas++][1] = t + 1;
+        }
+        if (t + lado < numTerritorios) {
+            arestas[numArestas][0] = t;
+            arestas[numArestas++][1] = t + lado;
+        }
+    }
+    for (int t = 0; t < numTerritorios; t++) {
+        strcpy(mapa[t].corExercito, NOMES_CORES[sortearInt(NUM_CORES)]);
+        mapa[t].numTropas = 1 + sortearInt(MAX_TROPAS_ATAQUE);
+        mapa[t].vida = sortearInt(MAX_VIDA + 1);
+        mapa[t].poder = MAX_VIDA - mapa[t].vida;
+    }
+    
+    struct timespec inicio, meio, fim;
+    GrafoTerritorios grafo;
+    MapaInfluencia incremental, completo;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    int criado = grafoCriar(&grafo, numTerritorios, (const int (*)[2])arestas, numArestas);
+    free(arestas);
+    if (!criado || !influenciaCriar(&incremental, &grafo, mapa)) {
+        printf("Erro: Nao foi possivel alocar memoria para o mapa de influencia!\n");
+        if (criado) grafoLiberar(&grafo);
+        free(mapa);
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &meio);
+    
+    // Mudancas como as de um ataque: tropas e vida, e as vezes o dono do territorio
+    for (int i = 0; i < numTerritorios; i++) {
+        int t = sortearInt(numTerritorios);
+        mapa[t].numTropas = 1 + sortearInt(MAX_TROPAS_ATAQUE);
+        mapa[t].vida = sortearInt(MAX_VIDA + 1);
+        if (sortearInt(4) == 0) {
+            strcpy(mapa[t].corExercito, NOMES_CORES[sortearInt(NUM_CORES)]);
+        }
+        influenciaSincronizar(&incremental, mapa, t);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundosCriar = (meio.tv_sec - inicio.tv_sec) + (meio.tv_nsec - inicio.tv_nsec) / 1e9;
+    double segundosAtualizar = (fim.tv_sec - meio.tv_sec) + (fim.tv_nsec - meio.tv_nsec) / 1e9;
+    
+    long diferentes = -1;
+    if (influenciaCriar(&completo, &grafo, mapa)) {
+        diferentes = 0;
+        for (long i = 0; i < (long)numTerritorios * INFLUENCIA_CORES; i++) {
+            if (incremental.influencia[i] != completo.influencia[i]) diferentes++;
+        }
+        for (int t = 0; t < numTerritorios; t++) {
+            if (incremental.dono[t] != completo.dono[t] || incremental.forca[t] != completo.forca[t]) diferentes++;
+        }
+        influenciaLiberar(&completo);
+    }
+    
+    printf("Grade de %d colunas: %d territorios, %d fronteiras\n", lado, numTerritorios, numArestas);
+    printf("Construcao completa: %.1f ms\n", segundosCriar * 1000);
+    printf("%d atualizacoes incrementais: %.1f ms (%.2f us cada)\n", numTerritorios,
+           segundosAtualizar * 1000, segundosAtualizar * 1e6 / numTerritorios);
+    if (diferentes < 0) {
+        printf("Erro: Nao foi possivel alocar memoria para a reconstrucao!\n");
+    } else {
+        printf("Comparacao com a reconstrucao: %s (%ld valores diferentes)\n",
+               diferentes == 0 ? "identico" : "DIVERGENTE", diferentes);
+    }
+    
+    influenciaLiberar(&incremental);
+    grafoLiberar(&grafo);
+    free(mapa);
+    return diferentes == 0;
+}
+
+// concluirTarefa():
+// Marca a tarefa como pronta e acorda o laco principal.
+static void concluirTarefa(PreCalculo* precalculo, int tarefa) {
+    pthread_mutex_lock(&precalculo->trava);
+    precalculo->prontos |= tarefa;
+    pthread_cond_broadcast(&precalculo->sinal);
+    pthread_mutex_unlock(&precalculo->trava);
+}
+
+// tarefaEstatisticas():
+// Calcula as estatisticas por cor usadas no ranking.
+static void* tarefaEstatisticas(void* argumento) {
+    PreCalculo* precalculo = (PreCalculo*)argumento;
+    calcularEstatisticas(precalculo->mapa, precalculo->estatisticas);
+    concluirTarefa(precalculo, PRECALCULO_ESTATISTICAS);
+    return NULL;
+}
+
+// tarefaRecomendacao():
+// Escolhe o ataque recomendado pela politica automatica e estima suas chances: vitoria na
+// proxima batalha (exata) e conquista repetindo o mesmo ataque (simulacao sobre copias).
+static void* tarefaRecomendacao(void* argumento) {
+    PreCalculo* precalculo = (PreCalculo*)argumento;
+    semearAleatorio(precalculo->semente + 1);
+    
+    precalculo->temRecomendacao = escolherAtaqueAutomatico(precalculo->mapa, &precalculo->jogador, precalculo->idMissao,
+                                                          &precalculo->origem, &precalculo->destino, &precalculo->tropas);
+    if (precalculo->temRecomendacao) {
+        const Territorio* origem = &precalculo->mapa[precalculo->origem];
+        const Territorio* destino = &precalculo->mapa[precalculo->destino];
+        precalculo->chanceVitoria = chanceVitoriaBatalha(origem, destino, precalculo->tropas);
+        
+        int conquistas = 0, simulacoes = 0;
+        for (; simulacoes < PRECALCULO_SIMULACOES_CONQUISTA && !atomic_load(&precalculo->cancelar); simulacoes++) {
+            Territorio atacante = *origem, defensor = *destino;
+            Jogador jogador = precalculo->jogador;
+            int tropas = precalculo->tropas;
+            
+            while (atacante.numTropas > 1) {
+                if (tropas > atacante.numTropas - 1) tropas = atacante.numTropas - 1;
+                if (resolverAtaque(&atacante, &defensor, &jogador, tropas).conquistou) {
+                    conquistas++;
+                    break;
+                }
+            }
+        }
+        precalculo->chanceConquista = simulacoes > 0 ? (double)conquistas / simulacoes : 0;
+    }
+    concluirTarefa(precalculo, PRECALCULO_RECOMENDACAO);
+    return NULL;
+}
+
+// tarefaMissao():
+// Estima a chance de cumprir a missao continuando a partida com a politica automatica.
+static void* tarefaMissao(void* argumento) {
+    PreCalculo* precalculo = (PreCalculo*)argumento;
+    semearAleatorio(precalculo->semente + 2);
+    
+    int sucessos = 0, simulacoes = 0;
+    for (; simulacoes < PRECALCULO_SIMULACOES_MISSAO && !atomic_load(&precalculo->cancelar); simulacoes++) {
+        Territorio mapa[NUM_TERRITORIOS];
+        Jogador jogador = precalculo->jogador;
+        memcpy(mapa, precalculo->mapa, sizeof(mapa));
+        sucessos += simularAteFim(mapa, &jogador, precalculo->idMissao, SIMULACAO_MAX_TURNOS);
+    }
+    precalculo->chanceMissao = simulacoes > 0 ? (double)sucessos / simulacoes : 0;
+    concluirTarefa(precalculo, PRECALCULO_MISSAO);
+    return NULL;
+}
+
+// dispararTarefas():
+// Copia o estado e inicia uma thread por tarefa. As copias nao participam do placar global.
+static void dispararTarefas(PreCalculo* precalculo, const Territorio* mapa, const Jogador* jogador, int idMissao) {
+    static void* (*const TAREFAS[PRECALCULO_TAREFAS])(void*) = {tarefaEstatisticas, tarefaRecomendacao, tarefaMissao};
+    
+    memcpy(precalculo->mapa, mapa, sizeof(precalculo->mapa));
+    precalculo->jogador = *jogador;
+    precalculo->jogador.idPlacar = 0;
+    precalculo->idMissao = idMissao;
+    precalculo->semente = (unsigned long long)sortearInt(1 << 30) << 20;
+    precalculo->prontos = 0;
+    precalculo->avisados = 0;
+    atomic_store(&precalculo->cancelar, 0);
+    
+    precalculo->tarefasAtivas = 0;
+    for (int i = 0; i < PRECALCULO_TAREFAS; i++) {
+        if (pthread_create(&precalculo->tarefas[precalculo->tarefasAtivas], NULL, TAREFAS[i], precalculo) == 0) {
+            precalculo->tarefasAtivas++;
+        } else {
+            TAREFAS[i](precalculo); // Sem thread disponivel, calcula na hora
+        }
+    }
+}
+
+// lerLinhaTeclado():
+// Le uma linha do teclado; o restante de uma linha maior que o buffer e descartado.
+// Retorna 0 no fim da entrada.
+static int lerLinhaTeclado(char linha[MAX_LINHA_ENTRADA]) {
+    if (fgets(linha, MAX_LINHA_ENTRADA, stdin) == NULL) {
+        return 0;
+    }
+    if (strchr(linha, '\n') == NULL && !feof(stdin)) {
+        limparBufferEntrada();
+    }
+    return 1;
+}
+
+// lerLinhaEntrada():
+// Corpo da thread leitora: a cada linha pedida pelo laco principal, bloqueia no teclado no
+// lugar dele. Termina no fim da entrada ou quando precalculoEncerrar() pede.
+static void* lerLinhaEntrada(void* argumento) {
+    PreCalculo* precalculo = (PreCalculo*)argumento;
+    char linha[MAX_LINHA_ENTRADA];
+    int lida = 1;
+    
+    while (lida) {
+        pthread_mutex_lock(&precalculo->trava);
+        while (!precalculo->linhaPedida && !precalculo->encerrarLeitor) {
+            pthread_cond_wait(&precalculo->sinal, &precalculo->trava);
+        }
+        int encerrar = precalculo->encerrarLeitor;
+        pthread_mutex_unlock(&precalculo->trava);
+        if (encerrar) {
+            break;
+        }
+        
+        lida = lerLinhaTeclado(linha);
+        
+        pthread_mutex_lock(&precalculo->trava);
+        if (lida) {
+            memcpy(precalculo->linha, linha, sizeof(linha));
+        }
+        precalculo->linhaPedida = 0;
+        precalculo->linhaPronta = lida ? 1 : -1;
+        pthread_cond_broadcast(&precalculo->sinal);
+        pthread_mutex_unlock(&precalculo->trava);
+    }
+    return NULL;
+}
+
+// precalculoIniciar():
+// Prepara a trava, o sinal, inicia a thread leitora do teclado e dispara as analises do estado inicial.
+void precalculoIniciar(PreCalculo* precalculo, const Territorio* mapa, const Jogador* jogador, int idMissao) {
+    memset(precalculo, 0, sizeof(*precalculo));
+    pthread_mutex_init(&precalculo->trava, NULL);
+    pthread_cond_init(&precalculo->sinal, NULL);
+    precalculo->leitorAtivo = pthread_create(&precalculo->leitor, NULL, lerLinhaEntrada, precalculo) == 0;
+    dispararTarefas(precalculo, mapa, jogador, idMissao);
+}
+
+// pararTarefas():
+// Pede o cancelamento das analises em andamento e espera as threads terminarem.
+static void pararTarefas(PreCalculo* precalculo) {
+    atomic_store(&precalculo->cancelar, 1);
+    for (int i = 0; i < precalculo->tarefasAtivas; i++) {
+        pthread_join(precalculo->tarefas[i], NULL);
+    }
+    precalculo->tarefasAtivas = 0;
+}
+
+// precalculoReiniciar():
+// Descarta as analises do estado anterior e recomeca sobre o estado atual.
+void precalculoReiniciar(PreCalculo* precalculo, const Territorio* mapa, const Jogador* jogador, int idMissao) {
+    pararTarefas(precalculo);
+    dispararTarefas(precalculo, mapa, jogador, idMissao);
+}
+
+// precalculoAguardar():
+// Espera ate que todas as tarefas pedidas estejam prontas (normalmente ja estao).
+void precalculoAguardar(PreCalculo* precalculo, int tarefas) {
+    pthread_mutex_lock(&precalculo->trava);
+    while ((precalculo->prontos & tarefas) != tarefas) {
+        pthread_cond_wait(&precalculo->sinal, &precalculo->trava);
+    }
+    pthread_mutex_unlock(&precalculo->trava);
+}
+
+// precalculoEncerrar():
+// Cancela as analises pendentes, encerra a thread leitora e libera a trava e o sinal.
+// A thread leitora so bloqueia no teclado quando uma linha foi pedida, entao aqui ela
+// esta esperando o sinal (ou ja terminou no fim da entrada).
+void precalculoEncerrar(PreCalculo* precalculo) {
+    pararTarefas(precalculo);
+    if (precalculo->leitorAtivo) {
+        pthread_mutex_lock(&precalculo->trava);
+        precalculo->encerrarLeitor = 1;
+        pthread_cond_broadcast(&precalculo->sinal);
+        pthread_mutex_unlock(&precalculo->trava);
+        pthread_join(precalculo->leitor, NULL);
+    }
+    pthread_cond_destroy(&precalculo->sinal);
+    pthread_mutex_destroy(&precalculo->trava);
+}
+
+// chanceVitoriaBatalha():
+// Probabilidade exata de o atacante vencer uma batalha, enumerando os 36 pares de dados.
+double chanceVitoriaBatalha(const Territorio* origem, const Territorio* destino, int tropasAtaque) {
+    const ParametrosCombate* regras = regrasDaThread;
+    int vantagem = (origem->poder / regras->divisorPoder + tropasAtaque) -
+                   (destino->poder / regras->divisorPoder + destino->numTropas);
+    int vitorias = 0;
+    
+    for (int dadoAtacante = 1; dadoAtacante <= 6; dadoAtacante++) {
+        for (int dadoDefensor = 1; dadoDefensor <= 6; dadoDefensor++) {
+            vitorias += dadoAtacante + vantagem > dadoDefensor;
+        }
+    }
+    return vitorias / 36.0;
+}
+
+// avisarResultados():
+// Exibe, uma unica vez, as analises que ficaram prontas. Chamada com a trava obtida.
+static int avisarResultados(PreCalculo* precalculo) {
+    int novos = precalculo->prontos & ~precalculo->avisados;
+    precalculo->avisados |= novos;
+    
+    if ((novos & PRECALCULO_RECOMENDACAO) && precalculo->temRecomendacao) {
+        printf("\n[analise] Recomendacao: atacar %s a partir de %s com %d tropas "
+               "(vitoria %.0f%%, conquista %.0f%%)\n",
+               precalculo->mapa[precalculo->destino].nome, precalculo->mapa[precalculo->origem].nome,
+               precalculo->tropas, precalculo->chanceVitoria * 100, precalculo->chanceConquista * 100);
+    }
+    if (novos & PRECALCULO_MISSAO) {
+        printf("\n[analise] Chance estimada de cumprir a missao: %.0f%%\n", precalculo->chanceMissao * 100);
+    }
+    return (novos & (PRECALCULO_RECOMENDACAO | PRECALCULO_MISSAO)) != 0;
+}
+
+// exibirPreCalculo():
+// Exibe as previsoes de segundo plano, aguardando as que ainda nao terminaram.
+void exibirPreCalculo(PreCalculo* precalculo) {
+    precalculoAguardar(precalculo, PRECALCULO_RECOMENDACAO | PRECALCULO_MISSAO);
+    
+    pthread_mutex_lock(&precalculo->trava);
+    precalculo->avisados |= PRECALCULO_RECOMENDACAO | PRECALCULO_MISSAO; // Ja exibidas aqui
+    pthread_mutex_unlock(&precalculo->trava);
+    
+    printf("\n=== PREVISOES ===\n");
+    if (precalculo->temRecomendacao) {
+        printf("Ataque sugerido: %s -> %s com %d tropas\n",
+               precalculo->mapa[precalculo->origem].nome, precalculo->mapa[precalculo->destino].nome, precalculo->tropas);
+        printf("Chance de vencer a batalha: %.1f%%\n", precalculo->chanceVitoria * 100);
+        printf("Chance de conquistar repetindo o ataque: %.1f%%\n", precalculo->chanceConquista * 100);
+    } else {
+        printf("Nenhum ataque possivel (e preciso ter um territorio com 2 tropas ou mais).\n");
+    }
+    printf("Chance estimada de cumprir a missao: %.1f%%\n", precalculo->chanceMissao * 100);
+    printf("=================\n");
+}
+
+// lerLinhaAssincrona():
+// Exibe o prompt (formato de printf) e espera por eventos: a linha digitada (lida pela thread
+// leitora) ou analises que terminaram, que sao exibidas assim que ficam prontas, repetindo o prompt.
+// A linha fica em precalculo->linha. Retorna 1 se uma linha foi lida ou 0 no fim da entrada.
+int lerLinhaAssincrona(PreCalculo* precalculo, const char* formato, ...) {
+    char prompt[MAX_LINHA_PROMPT];
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vsnprintf(prompt, sizeof(prompt), formato, argumentos);
+    va_end(argumentos);
+    
+    printf("%s", prompt);
+    fflush(stdout);
+    
+    if (!precalculo->leitorAtivo) {
+        // Sem thread leitora (ou a entrada ja terminou): le na hora
+        if (precalculo->linhaPronta < 0) {
+            return 0;
+        }
+        precalculo->linhaPronta = lerLinhaTeclado(precalculo->linha) ? 1 : -1;
+        return precalculo->linhaPronta > 0;
+    }
+    
+    pthread_mutex_lock(&precalculo->trava);
+    if (precalculo->linhaPronta >= 0) {
+        precalculo->linhaPronta = 0;
+        precalculo->linhaPedida = 1;
+        pthread_cond_broadcast(&precalculo->sinal);
+    }
+    while (!precalculo->linhaPronta) {
+        if (avisarResultados(precalculo)) {
+            printf("%s", prompt);
+            fflush(stdout);
+        }
+        if (!precalculo->linhaPronta) {
+            pthread_cond_wait(&precalculo->sinal, &precalculo->trava);
+        }
+    }
+    int lida = precalculo->linhaPronta > 0;
+    pthread_mutex_unlock(&precalculo->trava);
+    return lida;
+}
+
+// lerInteiroAssincrono():
+// Le uma linha com lerLinhaAssincrona() e a converte em inteiro.
+// Retorna o numero digitado ou 0 se a linha nao for um numero ou a entrada terminar;
+// como todos os valores pedidos ao jogador comecam em 1, 0 e sempre rejeitado por quem chama.
+int lerInteiroAssincrono(PreCalculo* precalculo, const char* formato, ...) {
+    char prompt[MAX_LINHA_PROMPT];
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vsnprintf(prompt, sizeof(prompt), formato, argumentos);
+    va_end(argumentos);
+    
+    int valor;
+    if (!lerLinhaAssincrona(precalculo, "%s", prompt) || sscanf(precalculo->linha, "%d", &valor) != 1) {
+        return 0;
+    }
+    return valor;
+}
+
+// lerOpcaoAssincrona():
+// Le a opcao de um menu com lerLinhaAssincrona(). Retorna a opcao escolhida,
+// 0 no fim da entrada ou -1 se a linha nao for um numero.
+int lerOpcaoAssincrona(PreCalculo* precalculo) {
+    int opcao;
+    if (!lerLinhaAssincrona(precalculo, "Escolha uma opcao: ")) {
+        return 0;
+    }
+    return sscanf(precalculo->linha, "%d", &opcao) == 1 ? opcao : -1;
+}
+
+// calcularDistribuicaoBlitz():
+// Programacao dinamica sobre (vitorias, derrotas) ate os estados finais: conquista (todas as
+// vitorias necessarias), atacante no limite de tropas (todas as derrotas permitidas) ou limite
+// de rodadas. A chance de vitoria em cada rodada depende apenas das tropas do defensor, que
+// diminuem uma por vitoria. Preenche a lista de desfechos com probabilidade acumulada.
+static int calcularDistribuicaoBlitz(DistribuicaoBlitz* distribuicao) {
+    int W = distribuicao->vitoriasNecessarias;
+    int L = distribuicao->derrotasPermitidas;
+    int R = distribuicao->maxRodadas;
+    
+    double* prob = (double*)calloc((size_t)(W + 1) * (L + 1), sizeof(double));
+    int capacidade = W + L + 2;
+    if (prob == NULL) {
+        return 0;
+    }
+    if (distribuicao->capacidade < capacidade) {
+        int* vitorias = (int*)realloc(distribuicao->vitorias, capacidade * sizeof(int));
+        if (vitorias != NULL) distribuicao->vitorias = vitorias;
+        int* derrotas = (int*)realloc(distribuicao->derrotas, capacidade * sizeof(int));
+        if (derrotas != NULL) distribuicao->derrotas = derrotas;
+        double* acumulada = (double*)realloc(distribuicao->acumulada, capacidade * sizeof(double));
+        if (acumulada != NULL) distribuicao->acumulada = acumulada;
+        double* chance = (double*)realloc(distribuicao->chance, capacidade * sizeof(double));
+        if (chance != NULL) distribuicao->chance = chance;
+        if (vitorias == NULL || derrotas == NULL || acumulada == NULL || chance == NULL) {
+            free(prob);
+            return 0;
+        }
+        distribuicao->capacidade = capacidade;
+    }
+    
+    // Chance de vitoria na rodada com w vitorias acumuladas (defensor com max(D0 - w, 1) tropas)
+    double* chance = distribuicao->chance;
+    for (int w = 0; w < W; w++) {
+        int tropasDefensor = distribuicao->tropasDefensor - w;
+        if (tropasDefensor < 1) tropasDefensor = 1;
+        int vencedoras = 0;
+        for (int dadoAtacante = 1; dadoAtacante <= 6; dadoAtacante++) {
+            for (int dadoDefensor = 1; dadoDefensor <= 6; dadoDefensor++) {
+                vencedoras += dadoAtacante + distribuicao->vantagemBase > dadoDefensor + tropasDefensor;
+            }
+        }
+        chance[w] = vencedoras / 36.0;
+    }
+    
+    distribuicao->quantidade = 0;
+    double total = 0;
+    prob[0] = 1.0;
+    
+    for (int w = 0; w <= W; w++) {
+        for (int l = 0; l <= L; l++) {
+            double p = prob[w * (L + 1) + l];
+            if (p == 0) continue;
+            
+            int final = (w == W) || (l == L) || (R > 0 && w + l == R);
+            if (final) {
+                total += p;
+                distribuicao->vitorias[distribuicao->quantidade] = w;
+                distribuicao->derrotas[distribuicao->quantidade] = l;
+                distribuicao->acumulada[distribuicao->quantidade] = total;
+                distribuicao->quantidade++;
+            } else {
+                prob[(w + 1) * (L + 1) + l] += p * chance[w];
+                prob[w * (L + 1) + l + 1] += p * (1 - chance[w]);
+            }
+        }
+    }
+    
+    free(prob);
+    return 1;
+}
+
+// obterDistribuicaoBlitz():
+// Retorna a distribuicao para os parametros, reaproveitando o cache da thread quando possivel.
+static const DistribuicaoBlitz* obterDistribuicaoBlitz(int vantagemBase, int tropasDefensor, int vitoriasNecessarias,
+                                                      int derrotasPermitidas, int maxRodadas) {
+    unsigned int chave = (unsigned int)vantagemBase * 31u + (unsigned int)tropasDefensor * 131u +
+                         (unsigned int)vitoriasNecessarias * 1031u + (unsigned int)derrotasPermitidas * 8191u +
+                         (unsigned int)maxRodadas * 65537u;
+    DistribuicaoBlitz* distribuicao = &cacheBlitz[chave % BLITZ_CACHE];
+    
+    if (distribuicao->valida && distribuicao->vantagemBase == vantagemBase &&
+        distribuicao->tropasDefensor == tropasDefensor && distribuicao->vitoriasNecessarias == vitoriasNecessarias &&
+        distribuicao->derrotasPermitidas == derrotasPermitidas && distribuicao->maxRodadas == maxRodadas) {
+        return distribuicao;
+    }
+    
+    distribuicao->vantagemBase = vantagemBase;
+    distribuicao->tropasDefensor = tropasDefensor;
+    distribuicao->vitoriasNecessarias = vitoriasNecessarias;
+    distribuicao->derrotasPermitidas = derrotasPermitidas;
+    distribuicao->maxRodadas = maxRodadas;
+    distribuicao->valida = calcularDistribuicaoBlitz(distribuicao);
+    return distribuicao->valida ? distribuicao : NULL;
+}
+
+// tropasAposDerrotas():
+// Tropas da origem depois de 'derrotas' batalhas perdidas, pela regra de resolverAtaque():
+// cada derrota tira tropasAtaque enquanto sobra alguma tropa, e depois a origem fica com 1.
+static int tropasAposDerrotas(int tropas, int tropasAtaque, int derrotas) {
+    int restantes = tropas - derrotas * tropasAtaque;
+    return restantes >= 1 ? restantes : 1;
+}
+
+// sortearOrdemBlitz():
+// Sorteia em que ordem aconteceram as vitorias e derrotas de um desfecho ja sorteado.
+// Dado o desfecho, cada ordem possivel tem probabilidade proporcional ao produto de (1 - chance[k])
+// das suas derrotas, onde k e o numero de vitorias antes de cada derrota; por isso basta sortear
+// quantas derrotas caem em cada nivel k, com pesos acumulados de tras para frente.
+// A conquista termina com vitoria e o limite de derrotas termina com derrota.
+// Preenche 'ordem' (1 = vitoria, 0 = derrota) e retorna 1, ou 0 se faltar memoria.
+static int sortearOrdemBlitz(const DistribuicaoBlitz* distribuicao, int vitorias, int derrotas, char* ordem) {
+    int conquista = vitorias == distribuicao->vitoriasNecessarias;
+    int terminaEmDerrota = !conquista && derrotas == distribuicao->derrotasPermitidas;
+    int ultimoNivel = conquista ? vitorias - 1 : vitorias;
+    int livres = derrotas - terminaEmDerrota;
+    int colunas = livres + 1;
+    
+    // peso[k * colunas + m]: soma dos pesos de todas as formas de distribuir m derrotas nos niveis k em diante
+    double* peso = (double*)calloc((size_t)(ultimoNivel + 2) * colunas, sizeof(double));
+    if (peso == NULL) {
+        return 0;
+    }
+    peso[(ultimoNivel + 1) * colunas] = 1.0;
+    for (int k = ultimoNivel; k >= 0; k--) {
+        double perda = 1 - distribuicao->chance[k];
+        for (int m = 0; m <= livres; m++) {
+            peso[k * colunas + m] = peso[(k + 1) * colunas + m] + (m > 0 ? perda * peso[k * colunas + m - 1] : 0);
+        }
+    }
+    
+    int rodada = 0, restantes = livres;
+    for (int k = 0; k <= ultimoNivel; k++) {
+        double perda = 1 - distribuicao->chance[k];
+        while (restantes > 0) {
+            double sorteio = (sortearInt(1 << 30) + 0.5) / (double)(1 << 30) * peso[k * colunas + restantes];
+            if (sorteio >= perda * peso[k * colunas + restantes - 1]) break;
+            ordem[rodada++] = 0;
+            restantes--;
+        }
+        if (k < vitorias) ordem[rodada++] = 1;
+    }
+    if (terminaEmDerrota) ordem[rodada++] = 0;
+    
+    free(peso);
+    return 1;
+}
+
+// resolverBlitz():
+// Resolve de uma vez o ataque repetido com as mesmas tropas ate conquistar o destino, ate a origem
+// ficar com tropasMinimas (minimo 1) ou ate maxRodadas batalhas (0 = sem limite). Em vez de rolar
+// batalha por batalha, sorteia o desfecho final da distribuicao exata de varias rodadas e aplica
+// o total de uma vez: as tropas da origem so dependem do numero de derrotas, o destino do numero
+// de vitorias e a conquista e sempre a ultima rodada. A ordem das vitorias e derrotas so e sorteada
+// quando importa: para as linhas do exportador de batalhas e quando o limite de pontos em zero pode
+// ser atingido no meio do ataque, detectado pela menor soma parcial da ordem sorteada. Com uma
+// transmissao ativa as rodadas sao aplicadas uma a uma, para que os espectadores vejam cada batalha.
+ResultadoBlitz resolverBlitz(Territorio* territorioOrigem, Territorio* territorioDestino, Jogador* jogador,
+                             int tropasAtaque, int tropasMinimas, int maxRodadas) {
+    ResultadoBlitz resultado = {0};
+    const ParametrosCombate* regras = regrasDaThread;
+    if (tropasMinimas < 1) tropasMinimas = 1;
+    
+    if (territorioOrigem->numTropas <= tropasMinimas || territorioOrigem->numTropas <= 1) {
+        resultado.status = ATAQUE_TROPAS_INSUFICIENTES;
+        return resultado;
+    }
+    if (strcmp(territorioDestino->corExercito, jogador->cor) == 0) {
+        resultado.status = ATAQUE_TERRITORIO_PROPRIO;
+        return resultado;
+    }
+    
+    int dano = tropasAtaque * regras->danoPorTropa;
+    int vitoriasNecessarias = (territorioDestino->vida + dano - 1) / dano;
+    if (vitoriasNecessarias < 1) vitoriasNecessarias = 1;
+    
+    // Derrotas ate a origem ficar com tropasMinimas ou menos
+    int derrotasPermitidas = (territorioOrigem->numTropas - tropasMinimas + tropasAtaque - 1) / tropasAtaque;
+    
+    int vantagemBase = territorioOrigem->poder / regras->divisorPoder + tropasAtaque - territorioDestino->poder / regras->divisorPoder;
+    const DistribuicaoBlitz* distribuicao = obterDistribuicaoBlitz(vantagemBase, territorioDestino->numTropas,
+                                                                   vitoriasNecessarias, derrotasPermitidas, maxRodadas);
+    if (distribuicao == NULL) {
+        resultado.status = ATAQUE_SEM_MEMORIA;
+        return resultado;
+    }
+    
+    // Sorteia o desfecho pela probabilidade acumulada (busca binaria)
+    double sorteio = (sortearInt(1 << 30) + 0.5) / (double)(1 << 30) * distribuicao->acumulada[distribuicao->quantidade - 1];
+    int inicio = 0, fim = distribuicao->quantidade - 1;
+    while (inicio < fim) {
+        int meio = (inicio + fim) / 2;
+        if (distribuicao->acumulada[meio] < sorteio) inicio = meio + 1;
+        else fim = meio;
+    }
+    resultado.vitorias = distribuicao->vitorias[inicio];
+    resultado.derrotas = distribuicao->derrotas[inicio];
+    resultado.rodadas = resultado.vitorias + resultado.derrotas;
+    resultado.conquistou = resultado.vitorias == vitoriasNecessarias;
+    
+    // Pontuacao das rodadas: 10 por vitoria e -5 por derrota, sem ficar negativa em nenhum momento
+    int pontosIniciais = jogador->pontos;
+    int pontos = pontosIniciais + 10 * resultado.vitorias - 5 * resultado.derrotas;
+    int limiteAtingivel = pontosIniciais < 5 * resultado.derrotas;
+    if (exportadorDaThread != NULL || transmissorDaThread != NULL || limiteAtingivel) {
+        char* ordem = (char*)malloc((size_t)resultado.rodadas + 1);
+        if (ordem == NULL || !sortearOrdemBlitz(distribuicao, resultado.vitorias, resultado.derrotas, ordem)) {
+            free(ordem);
+            resultado.status = ATAQUE_SEM_MEMORIA;
+            return resultado;
+        }
+        if (exportadorDaThread != NULL) {
+            exportadorRegistrarBlitz(exportadorDaThread, territorioOrigem, territorioDestino, tropasAtaque,
+                                     ordem, resultado.rodadas, resultado.conquistou);
+        }
+        if (transmissorDaThread != NULL) {
+            // Espectadores acompanham cada batalha: as rodadas sao aplicadas e publicadas uma a uma
+            for (int rodada = 0; rodada < resultado.rodadas; rodada++) {
+                ResultadoBatalha batalha = {0};
+                batalha.atacanteVenceu = ordem[rodada];
+                batalha.dano = ordem[rodada] ? dano : 0;
+                batalha.conquistou = resultado.conquistou && rodada == resultado.rodadas - 1;
+                aplicarDesfecho(territorioOrigem, territorioDestino, jogador, tropasAtaque, &batalha);
+                transmissorPublicar(transmissorDaThread, territorioOrigem, territorioDestino, jogador);
+            }
+            free(ordem);
+            return resultado;
+        }
+        if (limiteAtingivel) {
+            // Com o limite em zero, os pontos finais sao a soma das rodadas mais o maior entre os
+            // pontos iniciais e o quanto a menor soma parcial ficou abaixo de zero
+            int soma = 0, menorSoma = 0;
+            for (int rodada = 0; rodada < resultado.rodadas; rodada++) {
+                soma += ordem[rodada] ? 10 : -5;
+                if (soma < menorSoma) menorSoma = soma;
+            }
+            pontos = soma + (pontosIniciais > -menorSoma ? pontosIniciais : -menorSoma);
+        }
+        free(ordem);
+    }
+    
+    // Aplica o total das rodadas, como resolverAtaque() faria batalha por batalha
+    int tropasOrigem = tropasAposDerrotas(territorioOrigem->numTropas, tropasAtaque, resultado.derrotas);
+    if (resultado.conquistou) {
+        // A conquista e a ultima rodada
+        strcpy(territorioDestino->corExercito, jogador->cor);
+        territorioDestino->vida = territorioOrigem->vida / regras->divisorConquista;
+        territorioDestino->poder = territorioOrigem->poder / regras->divisorConquista;
+        territorioDestino->numTropas = tropasAtaque;
+        tropasOrigem -= tropasAtaque;
+        jogador->territoriosConquistados++;
+        pontos += 50; // 50 pontos por conquista
+    } else {
+        territorioDestino->vida -= resultado.vitorias * dano;
+        territorioDestino->numTropas = (territorioDestino->numTropas > resultado.vitorias) ?
+                                       territorioDestino->numTropas - resultado.vitorias : 1;
+    }
+    territorioOrigem->numTropas = tropasOrigem;
+    jogador->batalhasVencidas += resultado.vitorias;
+    jogador->batalhasPerdidas += resultado.derrotas;
+    
+    // O placar recebe a soma das variacoes que atualizarPontuacao() teria repassado uma a uma
+    placarSomar(jogador->idPlacar, pontos - pontosIniciais, resultado.vitorias, resultado.conquistou);
+    jogador->pontos = pontos;
+    return resultado;
+}
+
+// liberarCacheBlitz():
+// Libera as distribuicoes de ataque relampago guardadas pela thread atual.
+// Chamar ao fim de toda thread que usou resolverBlitz().
+void liberarCacheBlitz(void) {
+    for (int i = 0; i < BLITZ_CACHE; i++) {
+        DistribuicaoBlitz* distribuicao = &cacheBlitz[i];
+        free(distribuicao->vitorias);
+        free(distribuicao->derrotas);
+        free(distribuicao->acumulada);
+        free(distribuicao->chance);
+        memset(distribuicao, 0, sizeof(*distribuicao));
+    }
+}
+
+// nomeMemoriaCompartilhada():
+// Nomes de memoria compartilhada POSIX comecam com '/'; acrescenta a barra se faltar.
+static void nomeMemoriaCompartilhada(char* destino, size_t tamanho, const char* nome) {
+    snprintf(destino, tamanho, "%s%s", nome[0] == '/' ? "" : "/", nome);
+}
+
+// gravarInteiro() / gravarCurto() / lerInteiro():
+// Inteiros de 32 e 16 bits em little-endian dentro de mensagens e registros binarios.
+static void gravarInteiro(unsigned char* destino, int valor) {
+    unsigned int bits = (unsigned int)valor;
+    for (int i = 0; i < 4; i++) destino[i] = (unsigned char)(bits >> (8 * i));
+}
+
+static void gravarCurto(unsigned char* destino, int valor) {
+    destino[0] = (unsigned char)valor;
+    destino[1] = (unsigned char)(valor >> 8);
+}
+
+static int lerInteiro(const unsigned char* origem) {
+    unsigned int bits = 0;
+    for (int i = 0; i < 4; i++) bits |= (unsigned int)origem[i] << (8 * i);
+    return (int)bits;
+}
+
+// transmissaoEscrever():
+// Escreve uma mensagem de TRANSMISSAO_BYTES no proximo slot do anel. So o produtor chama.
+static void transmissaoEscrever(AnelTransmissao* anel, const unsigned char* mensagem) {
+    unsigned long long numero = atomic_load_explicit(&anel->cabeca, memory_order_relaxed);
+    SlotTransmissao* slot = &anel->slots[numero % anel->numSlots];
+    
+    atomic_store_explicit(&slot->sequencia, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (int i = 0; i < TRANSMISSAO_PALAVRAS; i++) {
+        unsigned long long palavra = 0;
+        for (int b = 0; b < 8; b++) palavra |= (unsigned long long)mensagem[i * 8 + b] << (8 * b);
+        atomic_store_explicit(&slot->dados[i], palavra, memory_order_relaxed);
+    }
+    atomic_store_explicit(&slot->sequencia, numero + 1, memory_order_release);
+    atomic_store_explicit(&anel->cabeca, numero + 1, memory_order_release);
+}
+
+// transmissaoLer():
+// Copia a mensagem 'numero' do anel. Retorna 1 se leu, 0 se ainda nao foi publicada
+// e -1 se ja foi sobrescrita (o leitor ficou para tras).
+static int transmissaoLer(const AnelTransmissao* anel, unsigned long long numero, unsigned char* mensagem) {
+    unsigned long long cabeca = atomic_load_explicit(&((AnelTransmissao*)anel)->cabeca, memory_order_acquire);
+    if (numero >= cabeca) return 0;
+    if (cabeca - numero > anel->numSlots) return -1;
+    
+    SlotTransmissao* slot = (SlotTransmissao*)&anel->slots[numero % anel->numSlots];
+    if (atomic_load_explicit(&slot->sequencia, memory_order_acquire) != numero + 1) return -1;
+    for (int i = 0; i < TRANSMISSAO_PALAVRAS; i++) {
+        unsigned long long palavra = atomic_load_explicit(&slot->dados[i], memory_order_relaxed);
+        for (int b = 0; b < 8; b++) mensagem[i * 8 + b] = (unsigned char)(palavra >> (8 * b));
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->sequencia, memory_order_relaxed) == numero + 1 ? 1 : -1;
+}
+
+// Formato das mensagens (bytes):
+//   territorio: [0] tipo [1] indice [2] mascara [4..7] turno [8..11] tropas [12..15] vida
+//               [16..19] poder [20..29] cor [30..55] nome (apenas em quadros completos)
+//   jogador:    [0] tipo [2] mascara [4..7] turno [8..11] pontos [12..15] vencidas
+//               [16..19] perdidas [20..23] conquistados [24..33] cor [34..55] nome
+//   quadro:     [0] tipo [1] numero de territorios [4..7] turno
+
+// transmitirTerritorio():
+static void transmitirTerritorio(AnelTransmissao* anel, const Territorio* territorio, int indice, int mascara, int turno) {
+    unsigned char mensagem[TRANSMISSAO_BYTES] = {0};
+    mensagem[0] = TRANSMISSAO_TERRITORIO;
+    mensagem[1] = (unsigned char)indice;
+    mensagem[2] = (unsigned char)mascara;
+    gravarInteiro(mensagem + 4, turno);
+    gravarInteiro(mensagem + 8, territorio->numTropas);
+    gravarInteiro(mensagem + 12, territorio->vida);
+    gravarInteiro(mensagem + 16, territorio->poder);
+    if (mascara & CAMPO_COR) memcpy(mensagem + 20, territorio->corExercito, MAX_COR - 1);
+    if (mascara & CAMPO_NOME) memcpy(mensagem + 30, territorio->nome, 25);
+    transmissaoEscrever(anel, mensagem);
+}
+
+// transmitirJogador():
+static void transmitirJogador(AnelTransmissao* anel, const Jogador* jogador, int mascara, int turno) {
+    unsigned char mensagem[TRANSMISSAO_BYTES] = {0};
+    mensagem[0] = TRANSMISSAO_JOGADOR;
+    mensagem[2] = (unsigned char)mascara;
+    gravarInteiro(mensagem + 4, turno);
+    gravarInteiro(mensagem + 8, jogador->pontos);
+    gravarInteiro(mensagem + 12, jogador->batalhasVencidas);
+    gravarInteiro(mensagem + 16, jogador->batalhasPerdidas);
+    gravarInteiro(mensagem + 20, jogador->territoriosConquistados);
+    memcpy(mensagem + 24, jogador->cor, MAX_COR - 1);
+    memcpy(mensagem + 34, jogador->nome, 21);
+    transmissaoEscrever(anel, mensagem);
+}
+
+// transmitirQuadro():
+// Publica o estado completo entre as mensagens de inicio e fim de quadro, para que
+// espectadores que chegaram agora (ou ficaram para tras) possam sincronizar.
+static void transmitirQuadro(Transmissor* transmissor, const Territorio* mapa, const Jogador* jogador, int turno) {
+    unsigned char mensagem[TRANSMISSAO_BYTES] = {0};
+    mensagem[0] = TRANSMISSAO_QUADRO;
+    mensagem[1] = NUM_TERRITORIOS;
+    gravarInteiro(mensagem + 4, turno);
+    transmissaoEscrever(transmissor->anel, mensagem);
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        transmitirTerritorio(transmissor->anel, &mapa[i], i,
+                             CAMPO_TROPAS | CAMPO_VIDA | CAMPO_PODER | CAMPO_COR | CAMPO_NOME, turno);
+    }
+    transmitirJogador(transmissor->anel, jogador, CAMPO_PONTOS | CAMPO_VENCIDAS | CAMPO_PERDIDAS | CAMPO_CONQUISTADOS, turno);
+    
+    mensagem[0] = TRANSMISSAO_FIM_QUADRO;
+    transmissaoEscrever(transmissor->anel, mensagem);
+    
+    memcpy(transmissor->anterior, mapa, sizeof(transmissor->anterior));
+    transmissor->jogadorAnterior = *jogador;
+}
+
+// transmissorAbrir():
+// Cria (ou recria) a memoria compartilhada 'nome' para transmitir o jogo de 'mapa' e publica
+// o primeiro quadro completo.
+// Retorna NULL se a memoria compartilhada nao puder ser criada.
+Transmissor* transmissorAbrir(const char* nome, const Territorio* mapa, const Jogador* jogador) {
+    Transmissor* transmissor = (Transmissor*)calloc(1, sizeof(Transmissor));
+    if (transmissor == NULL) return NULL;
+    nomeMemoriaCompartilhada(transmissor->nome, sizeof(transmissor->nome), nome);
+    transmissor->tamanho = sizeof(AnelTransmissao) + TRANSMISSAO_SLOTS * sizeof(SlotTransmissao);
+    
+    shm_unlink(transmissor->nome);
+    int descritor = shm_open(transmissor->nome, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (descritor < 0) {
+        free(transmissor);
+        return NULL;
+    }
+    if (ftruncate(descritor, (off_t)transmissor->tamanho) != 0) {
+        close(descritor);
+        shm_unlink(transmissor->nome);
+        free(transmissor);
+        return NULL;
+    }
+    void* memoria = mmap(NULL, transmissor->tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, descritor, 0);
+    close(descritor);
+    if (memoria == MAP_FAILED) {
+        shm_unlink(transmissor->nome);
+        free(transmissor);
+        return NULL;
+    }
+    
+    // A memoria nova vem zerada: todos os slots com sequencia 0 (vazios)
+    transmissor->anel = (AnelTransmissao*)memoria;
+    transmissor->anel->numSlots = TRANSMISSAO_SLOTS;
+    transmissor->anel->versao = TRANSMISSAO_VERSAO;
+    transmissor->anel->produtor = (int)getpid();
+    atomic_store_explicit(&transmissor->anel->cabeca, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    transmissor->anel->magico = TRANSMISSAO_MAGICO;
+    
+    transmissor->mapa = mapa;
+    transmitirQuadro(transmissor, mapa, jogador, 0);
+    return transmissor;
+}
+
+// transmissorAtivarNaThread():
+// Define a transmissao que recebe as batalhas resolvidas na thread atual (NULL desativa).
+void transmissorAtivarNaThread(Transmissor* transmissor) {
+    transmissorDaThread = transmissor;
+}
+
+// transmitirDiferencas():
+// Publica os campos do territorio 'indice' que mudaram desde a ultima publicacao.
+// Retorna 1 se algo foi publicado.
+static int transmitirDiferencas(Transmissor* transmissor, int indice) {
+    const Territorio* atual = &transmissor->mapa[indice];
+    Territorio* anterior = &transmissor->anterior[indice];
+    int mascara = 0;
+    if (atual->numTropas != anterior->numTropas) mascara |= CAMPO_TROPAS;
+    if (atual->vida != anterior->vida) mascara |= CAMPO_VIDA;
+    if (atual->poder != anterior->poder) mascara |= CAMPO_PODER;
+    if (strcmp(atual->corExercito, anterior->corExercito) != 0) mascara |= CAMPO_COR;
+    if (mascara == 0) return 0;
+    
+    transmitirTerritorio(transmissor->anel, atual, indice, mascara, transmissor->turnoAtual);
+    *anterior = *atual;
+    return 1;
+}
+
+// transmissorPublicar():
+// Publica uma batalha: apenas os campos que mudaram nos dois territorios envolvidos e no jogador.
+// Batalhas sobre outros mapas (copias das analises e simulacoes) sao ignoradas. A cada
+// TRANSMISSAO_INTERVALO_QUADRO publicacoes envia tambem um quadro completo.
+void transmissorPublicar(Transmissor* transmissor, const Territorio* territorioOrigem,
+                         const Territorio* territorioDestino, const Jogador* jogador) {
+    int indiceOrigem = -1, indiceDestino = -1;
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (&transmissor->mapa[i] == territorioOrigem) indiceOrigem = i;
+        if (&transmissor->mapa[i] == territorioDestino) indiceDestino = i;
+    }
+    if (indiceOrigem < 0 || indiceDestino < 0) {
+        return;
+    }
+    
+    int publicou = transmitirDiferencas(transmissor, indiceOrigem);
+    publicou |= transmitirDiferencas(transmissor, indiceDestino);
+    
+    int mascara = 0;
+    if (jogador->pontos != transmissor->jogadorAnterior.pontos) mascara |= CAMPO_PONTOS;
+    if (jogador->batalhasVencidas != transmissor->jogadorAnterior.batalhasVencidas) mascara |= CAMPO_VENCIDAS;
+    if (jogador->batalhasPerdidas != transmissor->jogadorAnterior.batalhasPerdidas) mascara |= CAMPO_PERDIDAS;
+    if (jogador->territoriosConquistados != transmissor->jogadorAnterior.territoriosConquistados) mascara |= CAMPO_CONQUISTADOS;
+    if (mascara != 0) {
+        transmitirJogador(transmissor->anel, jogador, mascara, transmissor->turnoAtual);
+        transmissor->jogadorAnterior = *jogador;
+        publicou = 1;
+    }
+    
+    if (publicou && ++transmissor->publicacoes % TRANSMISSAO_INTERVALO_QUADRO == 0) {
+        transmitirQuadro(transmissor, transmissor->mapa, jogador, transmissor->turnoAtual);
+    }
+}
+
+// transmissorFechar():
+// Avisa os espectadores que o jogo terminou e remove a memoria compartilhada.
+// Espectadores ja conectados continuam com o mapeamento ate sairem.
+void transmissorFechar(Transmissor* transmissor) {
+    if (transmissor == NULL) return;
+    
+    unsigned char mensagem[TRANSMISSAO_BYTES] = {0};
+    mensagem[0] = TRANSMISSAO_ENCERRAMENTO;
+    transmissaoEscrever(transmissor->anel, mensagem);
+    
+    munmap(transmissor->anel, transmissor->tamanho);
+    shm_unlink(transmissor->nome);
+    free(transmissor);
+}
+
+// esperarTransmissao():
+static void esperarTransmissao(void) {
+    struct timespec espera = {0, TRANSMISSAO_ESPERA_MS * 1000000L};
+    nanosleep(&espera, NULL);
+}
+
+// exibirQuadroEspectador():
+static void exibirQuadroEspectador(const Territorio* mapa, const Jogador* jogador, int turno) {
+    printf("\n=== QUADRO COMPLETO - TURNO %d ===\n", turno);
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        printf("%2d. %-15s | %-8s | Tropas: %3d | Vida: %4d | Poder: %4d\n",
+               i + 1, mapa[i].nome, mapa[i].corExercito, mapa[i].numTropas, mapa[i].vida, mapa[i].poder);
+    }
+    printf("Jogador %s (%s): %d pontos | %d vitorias | %d derrotas | %d conquistas\n",
+           jogador->nome, jogador->cor, jogador->pontos, jogador->batalhasVencidas,
+           jogador->batalhasPerdidas, jogador->territoriosConquistados);
+}
+
+// executarEspectador():
+// Acompanha um jogo publicado com --transmitir. Comeca pelo quadro completo mais recente
+// ainda no anel e depois aplica as diferencas no seu proprio ritmo, lendo direto da
+// memoria compartilhada. Se ficar para tras, descarta mensagens ate o proximo quadro.
+// Sai no encerramento ou, se o processo do jogo deixar de existir, sem ele.
+// Retorna 0 se a transmissao nao existir.
+int executarEspectador(const char* nome) {
+    char nomeCompleto[64];
+    nomeMemoriaCompartilhada(nomeCompleto, sizeof(nomeCompleto), nome);
+    
+    int descritor = shm_open(nomeCompleto, O_RDONLY, 0);
+    if (descritor < 0) {
+        printf("Erro: Nenhum jogo sendo transmitido em %s!\n", nomeCompleto);
+        return 0;
+    }
+    struct stat informacoes;
+    if (fstat(descritor, &informacoes) != 0 || (size_t)informacoes.st_size < sizeof(AnelTransmissao)) {
+        close(descritor);
+        printf("Erro: Transmissao %s invalida!\n", nomeCompleto);
+        return 0;
+    }
+    size_t tamanho = (size_t)informacoes.st_size;
+    void* memoria = mmap(NULL, tamanho, PROT_READ, MAP_SHARED, descritor, 0);
+    close(descritor);
+    if (memoria == MAP_FAILED) {
+        printf("Erro: Nao foi possivel mapear a transmissao %s!\n", nomeCompleto);
+        return 0;
+    }
+    const AnelTransmissao* anel = (const AnelTransmissao*)memoria;
+    if (anel->magico != TRANSMISSAO_MAGICO || anel->versao != TRANSMISSAO_VERSAO ||
+        sizeof(AnelTransmissao) + anel->numSlots * sizeof(SlotTransmissao) > tamanho) {
+        munmap(memoria, tamanho);
+        printf("Erro: Transmissao %s invalida!\n", nomeCompleto);
+        return 0;
+    }
+    
+    // Procura o quadro completo mais recente ainda disponivel no anel
+    unsigned char mensagem[TRANSMISSAO_BYTES];
+    unsigned long long cabeca = atomic_load_explicit(&((AnelTransmissao*)anel)->cabeca, memory_order_acquire);
+    unsigned long long proxima = cabeca;
+    for (unsigned long long n = cabeca; n > 0 && cabeca - n < anel->numSlots; n--) {
+        if (transmissaoLer(anel, n - 1, mensagem) == 1 && mensagem[0] == TRANSMISSAO_QUADRO) {
+            proxima = n - 1;
+            break;
+        }
+    }
+    
+    printf("=== ESPECTADOR: %s ===\n", nomeCompleto);
+    Territorio mapa[NUM_TERRITORIOS] = {0};
+    Jogador jogador = {0};
+    int sincronizado = 0;       // 1 depois do primeiro quadro completo
+    int emQuadro = 0;           // Recebendo um quadro completo
+    int esperas = 0;            // Esperas seguidas sem mensagem nova
+    
+    for (;;) {
+        int lida = transmissaoLer(anel, proxima, mensagem);
+        if (lida == 0) {
+            // O jogo pode ter parado sem publicar o encerramento (ex.: foi morto)
+            if (++esperas % TRANSMISSAO_ESPERAS_VERIFICACAO == 0 &&
+                kill((pid_t)anel->produtor, 0) != 0 && errno == ESRCH) {
+                printf("\n=== TRANSMISSAO INTERROMPIDA: o jogo parou sem encerrar ===\n");
+                break;
+            }
+            esperarTransmissao();
+            continue;
+        }
+        esperas = 0;
+        if (lida < 0) {
+            // Ficou para tras: pula para a mensagem mais antiga ainda no anel e espera um quadro
+            unsigned long long atual = atomic_load_explicit(&((AnelTransmissao*)anel)->cabeca, memory_order_acquire);
+            proxima = atual > anel->numSlots / 2 ? atual - anel->numSlots / 2 : 0;
+            sincronizado = 0;
+            emQuadro = 0;
+            printf("\n(espectador atrasado: aguardando o proximo quadro completo)\n");
+            continue;
+        }
+        proxima++;
+        
+        int tipo = mensagem[0];
+        int turno = lerInteiro(mensagem + 4);
+        if (tipo == TRANSMISSAO_ENCERRAMENTO) {
+            printf("\n=== FIM DA TRANSMISSAO ===\n");
+            break;
+        }
+        if (tipo == TRANSMISSAO_QUADRO) {
+            emQuadro = 1;
+            continue;
+        }
+        if (tipo == TRANSMISSAO_FIM_QUADRO) {
+            if (emQuadro && !sincronizado) {
+                exibirQuadroEspectador(mapa, &jogador, turno);
+                sincronizado = 1;
+            }
+            emQuadro = 0;
+            continue;
+        }
+        if (!sincronizado && !emQuadro) continue;
+        
+        int mascara = mensagem[2];
+        if (tipo == TRANSMISSAO_TERRITORIO && mensagem[1] < NUM_TERRITORIOS) {
+            Territorio* territorio = &mapa[mensagem[1]];
+            if (mascara & CAMPO_NOME) memcpy(territorio->nome, mensagem + 30, 25);
+            if (mascara & CAMPO_COR) memcpy(territorio->corExercito, mensagem + 20, MAX_COR - 1);
+            if (mascara & CAMPO_TROPAS) territorio->numTropas = lerInteiro(mensagem + 8);
+            if (mascara & CAMPO_VIDA) territorio->vida = lerInteiro(mensagem + 12);
+            if (mascara & CAMPO_PODER) territorio->poder = lerInteiro(mensagem + 16);
+            if (sincronizado && !emQuadro) {
+                printf("Turno %d: %s -> %s | Tropas: %d | Vida: %d | Poder: %d\n", turno, territorio->nome,
+                       territorio->corExercito, territorio->numTropas, territorio->vida, territorio->poder);
+            }
+        } else if (tipo == TRANSMISSAO_JOGADOR) {
+            memcpy(jogador.cor, mensagem + 24, MAX_COR - 1);
+            memcpy(jogador.nome, mensagem + 34, 21);
+            if (mascara & CAMPO_PONTOS) jogador.pontos = lerInteiro(mensagem + 8);
+            if (mascara & CAMPO_VENCIDAS) jogador.batalhasVencidas = lerInteiro(mensagem + 12);
+            if (mascara & CAMPO_PERDIDAS) jogador.batalhasPerdidas = lerInteiro(mensagem + 16);
+            if (mascara & CAMPO_CONQUISTADOS) jogador.territoriosConquistados = lerInteiro(mensagem + 20);
+            if (sincronizado && !emQuadro) {
+                printf("Turno %d: %s tem %d pontos (%d vitorias, %d derrotas, %d conquistas)\n", turno,
+                       jogador.nome, jogador.pontos, jogador.batalhasVencidas,
+                       jogador.batalhasPerdidas, jogador.territoriosConquistados);
+            }
+        }
+        fflush(stdout);
+    }
+    
+    munmap(memoria, tamanho);
+    return 1;
+}
+
+// escolherAtaqueAleatorio():
+// Politica aleatoria do autojogo: sorteia uma origem propria com tropas, um destino inimigo
+// e de 1 ate todas as tropas disponiveis. Retorna 0 se nao houver ataque possivel.
+int escolherAtaqueAleatorio(const Territorio* mapa, const Jogador* jogador, int* origem, int* destino, int* tropas) {
+    int origens[NUM_TERRITORIOS], destinos[NUM_TERRITORIOS];
+    int numOrigens = 0, numDestinos = 0;
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (strcmp(mapa[i].corExercito, jogador->cor) != 0) {
+            destinos[numDestinos++] = i;
+        } else if (mapa[i].numTropas > 1) {
+            origens[numOrigens++] = i;
+        }
+    }
+    if (numOrigens == 0 || numDestinos == 0) {
+        return 0;
+    }
+    
+    *origem = origens[sortearInt(numOrigens)];
+    *destino = destinos[sortearInt(numDestinos)];
+    int disponiveis = mapa[*origem].numTropas - 1;
+    if (disponiveis > MAX_TROPAS_ATAQUE) disponiveis = MAX_TROPAS_ATAQUE;
+    *tropas = sortearInt(disponiveis) + 1;
+    return 1;
+}
+
+// codificarAmostra():
+// Grava uma decisao no registro de AUTOJOGO_TAMANHO_REGISTRO bytes (little-endian):
+//   [0..251]    dono de cada territorio em one-hot (NUM_CORES bytes por territorio)
+//   [252..335]  tropas, [336..419] vida, [420..503] poder (16 bits por territorio)
+//   [504] missao  [505] cor do jogador  [506..507] turno
+//   [508] origem  [509] destino  [510] tropas  [511] resultado final (1 = missao cumprida)
+// O resultado e preenchido quando a partida termina.
+static void codificarAmostra(unsigned char* registro, const Territorio* mapa, const Jogador* jogador,
+                             int idMissao, int turno, int origem, int destino, int tropas) {
+    memset(registro, 0, AUTOJOGO_TAMANHO_REGISTRO);
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        int cor = indiceCor(mapa[i].corExercito);
+        if (cor >= 0) registro[i * NUM_CORES + cor] = 1;
+        gravarCurto(registro + 252 + 2 * i, mapa[i].numTropas);
+        gravarCurto(registro + 336 + 2 * i, mapa[i].vida);
+        gravarCurto(registro + 420 + 2 * i, mapa[i].poder);
+    }
+    registro[504] = (unsigned char)idMissao;
+    registro[505] = (unsigned char)indiceCor(jogador->cor);
+    gravarCurto(registro + 506, turno);
+    registro[508] = (unsigned char)origem;
+    registro[509] = (unsigned char)destino;
+    registro[510] = (unsigned char)tropas;
+}
+
+// executarTrabalhoAutojogo():
+// Corpo das threads do autojogo. Cada thread tem seu gerador, seu buffer de partida e seu
+// arquivo, sem nenhum estado compartilhado. As decisoes de uma partida ficam no buffer ate o
+// fim, quando o resultado e preenchido em todas e o lote e gravado de uma vez.
+static void* executarTrabalhoAutojogo(void* argumento) {
+    TrabalhoAutojogo* trabalho = (TrabalhoAutojogo*)argumento;
+    unsigned char* partida = (unsigned char*)malloc((size_t)SIMULACAO_MAX_TURNOS * AUTOJOGO_TAMANHO_REGISTRO);
+    FILE* arquivo = fopen(trabalho->caminho, "wb");
+    if (partida == NULL || arquivo == NULL) {
+        free(partida);
+        if (arquivo != NULL) fclose(arquivo);
+        return NULL;
+    }
+    setvbuf(arquivo, NULL, _IOFBF, EXPORTACAO_BUFFER_ARQUIVO);
+    
+    unsigned char cabecalho[16] = {0};
+    gravarInteiro(cabecalho, (int)AUTOJOGO_MAGICO);
+    gravarInteiro(cabecalho + 4, AUTOJOGO_VERSAO);
+    gravarInteiro(cabecalho + 8, AUTOJOGO_TAMANHO_REGISTRO);
+    gravarCurto(cabecalho + 12, NUM_TERRITORIOS);
+    gravarCurto(cabecalho + 14, NUM_CORES);
+    int sucesso = fwrite(cabecalho, sizeof(cabecalho), 1, arquivo) == 1;
+    
+    semearAleatorio(trabalho->semente);
+    for (int p = 0; p < trabalho->partidas && sucesso; p++) {
+        Territorio mapa[NUM_TERRITORIOS];
+        Jogador jogador = {0};
+        int idMissao = sortearInt(catalogoMissoes.quantidade) + 1;
+        int vida = sortearInt(MAX_VIDA + 1);
+        
+        inicializarTerritorios(mapa, NULL);
+        strcpy(jogador.nome, "Autojogo");
+        strcpy(jogador.cor, NOMES_CORES[sortearInt(NUM_CORES)]);
+        strcpy(jogador.paisOrigem, mapa[sortearInt(NUM_TERRITORIOS)].nome);
+        jogador.vida = vida;
+        jogador.poder = MAX_VIDA - vida;
+        jogador.pontos = 100;
+        inicializarTerritorios(mapa, &jogador);
+        
+        int decisoes = 0;
+        int venceu = 0;
+        for (int turno = 0; turno < SIMULACAO_MAX_TURNOS; turno++) {
+            if (verificarVitoria(mapa, idMissao, jogador.cor)) {
+                venceu = 1;
+                break;
+            }
+            
+            int origem, destino, tropas;
+            int escolheu = (trabalho->politica == POLITICA_GULOSA) ?
+                           escolherAtaqueAutomatico(mapa, &jogador, idMissao, &origem, &destino, &tropas) :
+                           escolherAtaqueAleatorio(mapa, &jogador, &origem, &destino, &tropas);
+            if (!escolheu) break;
+            
+            codificarAmostra(partida + (size_t)decisoes * AUTOJOGO_TAMANHO_REGISTRO, mapa, &jogador,
+                             idMissao, turno, origem, destino, tropas);
+            decisoes++;
+            resolverAtaque(&mapa[origem], &mapa[destino], &jogador, tropas);
+        }
+        if (decisoes == SIMULACAO_MAX_TURNOS) {
+            venceu = verificarVitoria(mapa, idMissao, jogador.cor);
+        }
+        
+        for (int i = 0; i < decisoes; i++) {
+            partida[(size_t)i * AUTOJOGO_TAMANHO_REGISTRO + AUTOJOGO_TAMANHO_REGISTRO - 1] = (unsigned char)venceu;
+        }
+        if (decisoes > 0 && fwrite(partida, AUTOJOGO_TAMANHO_REGISTRO, (size_t)decisoes, arquivo) != (size_t)decisoes) {
+            sucesso = 0;
+        }
+        trabalho->amostras += decisoes;
+        trabalho->vitorias += venceu;
+    }
+    
+    if (fclose(arquivo) != 0) sucesso = 0;
+    free(partida);
+    trabalho->sucesso = sucesso;
+    return NULL;
+}
+
+// executarAutojogo():
+// Gera dados de treino: joga 'partidas' partidas automaticas com a politica escolhida,
+// divididas entre as threads, e grava cada decisao (estado, ataque e resultado final) em
+// <prefixo>.<thread>.bin. Cada arquivo comeca com um cabecalho de 16 bytes: magico, versao,
+// tamanho do registro, numero de territorios e numero de cores. Retorna 1 em caso de sucesso.
+int executarAutojogo(const char* prefixo, const char* politica, int numThreads, int partidas) {
+    PoliticaAutojogo escolhida = POLITICA_GULOSA;
+    if (politica != NULL && strcmp(politica, "aleatoria") == 0) {
+        escolhida = POLITICA_ALEATORIA;
+    } else if (politica != NULL && strcmp(politica, "gulosa") != 0) {
+        printf("Erro: Politica desconhecida %s (use gulosa ou aleatoria)!\n", politica);
+        return 0;
+    }
+    if (numThreads > partidas) numThreads = partidas;
+    
+    TrabalhoAutojogo* trabalhos = (TrabalhoAutojogo*)calloc((size_t)numThreads, sizeof(TrabalhoAutojogo));
+    if (trabalhos == NULL) {
+        printf("Erro: Nao foi possivel alocar memoria para o autojogo!\n");
+        return 0;
+    }
+    
+    printf("Autojogo: %d partidas com politica %s em %d threads...\n",
+           partidas, escolhida == POLITICA_GULOSA ? "gulosa" : "aleatoria", numThreads);
+    
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    unsigned long long semente = (unsigned long long)time(NULL);
+    
+    for (int i = 0; i < numThreads; i++) {
+        TrabalhoAutojogo* trabalho = &trabalhos[i];
+        trabalho->politica = escolhida;
+        trabalho->partidas = partidas / numThreads + (i < partidas % numThreads);
+        trabalho->semente = semente * 1000003ULL + (unsigned long long)i;
+        snprintf(trabalho->caminho, sizeof(trabalho->caminho), "%s.%d.bin", prefixo, i);
+        trabalho->iniciada = pthread_create(&trabalho->thread, NULL, executarTrabalhoAutojogo, trabalho) == 0;
+        if (!trabalho->iniciada) {
+            executarTrabalhoAutojogo(trabalho);
+        }
+    }
+    for (int i = 0; i < numThreads; i++) {
+        if (trabalhos[i].iniciada) pthread_join(trabalhos[i].thread, NULL);
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    long amostras = 0;
+    int vitorias = 0, sucesso = 1;
+    for (int i = 0; i < numThreads; i++) {
+        amostras += trabalhos[i].amostras;
+        vitorias += trabalhos[i].vitorias;
+        if (!trabalhos[i].sucesso) {
+            printf("Erro: Nao foi possivel gravar %s!\n", trabalhos[i].caminho);
+            sucesso = 0;
+        }
+    }
+    free(trabalhos);
+    
+    printf("%ld amostras em %.2f s (%.0f amostras/s), missoes cumpridas em %d de %d partidas.\n",
+           amostras, segundos, segundos > 0 ? amostras / segundos : 0.0, vitorias, partidas);
+    return sucesso;
+}
+
+// prepararFinalDeJogo():
+// Monta a posicao de final de jogo a partir do mapa: alvos vindos das condicoes "sem cor" e
+// "continente" da missao, origens do jogador com tropas para atacar e a tabela de dados.
+// Exibe o motivo e retorna 0 se a missao ou a posicao nao puderem ser resolvidas exatamente.
+int prepararFinalDeJogo(const Territorio* mapa, const Jogador* jogador, int idMissao, FinalDeJogo* final) {
+    const ParametrosCombate* regras = regrasDaThread;
+    memset(final, 0, sizeof(*final));
+    
+    if (idMissao < 1 || idMissao > catalogoMissoes.quantidade) {
+        printf("Missao invalida!\n");
+        return 0;
+    }
+    
+    int alvo[NUM_TERRITORIOS] = {0};
+    const unsigned char* pc = catalogoMissoes.missoes[idMissao - 1].codigo;
+    while (pc[0] != OP_FIM) {
+        if (pc[0] == OP_SEM_COR) {
+            if (strcmp(NOMES_CORES[pc[1]], jogador->cor) == 0) {
+                printf("A missao exige eliminar a propria cor do jogador.\n");
+                return 0;
+            }
+            for (int i = 0; i < NUM_TERRITORIOS; i++) {
+                if (strcmp(mapa[i].corExercito, NOMES_CORES[pc[1]]) == 0) alvo[i] = 1;
+            }
+            pc += 2;
+        } else if (pc[0] == OP_CONTINENTE) {
+            const Continente* continente = &CONTINENTES[pc[1]];
+            for (int i = continente->inicio; i < continente->inicio + continente->quantidade; i++) {
+                if (strcmp(mapa[i].corExercito, jogador->cor) != 0) alvo[i] = 1;
+            }
+            pc += 2;
+        } else {
+            printf("So missoes de eliminar cores e conquistar continentes tem solucao exata.\n");
+            return 0;
+        }
+    }
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (!alvo[i]) continue;
+        if (final->numAlvos == FINAL_MAX_ALVOS) {
+            printf("Faltam mais de %d territorios para a missao; ainda e cedo para a solucao exata.\n", FINAL_MAX_ALVOS);
+            return 0;
+        }
+        int faixa = (mapa[i].vida + regras->danoPorTropa - 1) / regras->danoPorTropa;
+        if (mapa[i].numTropas > FINAL_MAX_TROPAS_ALVO || faixa > FINAL_MAX_FAIXA_VIDA) {
+            printf("%s tem tropas ou vida demais para a solucao exata.\n", mapa[i].nome);
+            return 0;
+        }
+        // Alvos ordenados por bonus, para que alvos intercambiaveis fiquem juntos
+        int bonus = mapa[i].poder / regras->divisorPoder;
+        int n = final->numAlvos++;
+        for (; n > 0 && final->bonusAlvo[n - 1] > bonus; n--) {
+            final->alvos[n] = final->alvos[n - 1];
+            final->bonusAlvo[n] = final->bonusAlvo[n - 1];
+            final->tropasAlvo[n] = final->tropasAlvo[n - 1];
+            final->faixaAlvo[n] = final->faixaAlvo[n - 1];
+        }
+        final->alvos[n] = i;
+        final->bonusAlvo[n] = bonus;
+        final->tropasAlvo[n] = mapa[i].numTropas > 1 ? mapa[i].numTropas : 1;
+        final->faixaAlvo[n] = faixa > 1 ? faixa : 1;
+    }
+    for (int n = 0; n < final->numAlvos; n++) {
+        final->grupoAlvo[n] = (n > 0 && final->bonusAlvo[n - 1] == final->bonusAlvo[n]) ? final->grupoAlvo[n - 1] : n;
+    }
+    
+    // Origens: os territorios do jogador com mais tropas (insercao ordenada)
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (strcmp(mapa[i].corExercito, jogador->cor) != 0 || mapa[i].numTropas <= 1) continue;
+        int n = final->numOrigens < FINAL_MAX_ORIGENS ? final->numOrigens++ : FINAL_MAX_ORIGENS;
+        while (n > 0 && mapa[final->origens[n - 1]].numTropas < mapa[i].numTropas) {
+            if (n < FINAL_MAX_ORIGENS) final->origens[n] = final->origens[n - 1];
+            n--;
+        }
+        if (n < FINAL_MAX_ORIGENS) final->origens[n] = i;
+    }
+    for (int o = 0; o < final->numOrigens; o++) {
+        const Territorio* origem = &mapa[final->origens[o]];
+        if (origem->numTropas > FINAL_MAX_TROPAS_ORIGEM) {
+            printf("%s tem tropas demais para a solucao exata.\n", origem->nome);
+            return 0;
+        }
+        // Reordena as escolhidas por bonus, para que origens intercambiaveis fiquem juntas
+        int bonus = origem->poder / regras->divisorPoder;
+        int indice = final->origens[o];
+        int n = o;
+        for (; n > 0 && final->bonusOrigem[n - 1] > bonus; n--) {
+            final->origens[n] = final->origens[n - 1];
+            final->bonusOrigem[n] = final->bonusOrigem[n - 1];
+            final->tropasOrigem[n] = final->tropasOrigem[n - 1];
+        }
+        final->origens[n] = indice;
+        final->bonusOrigem[n] = bonus;
+        final->tropasOrigem[n] = mapa[indice].numTropas;
+    }
+    for (int o = 0; o < final->numOrigens; o++) {
+        final->grupoOrigem[o] = (o > 0 && final->bonusOrigem[o - 1] == final->bonusOrigem[o]) ? final->grupoOrigem[o - 1] : o;
+    }
+    
+    for (int k = -6; k <= 6; k++) {
+        for (int dadoAtacante = 1; dadoAtacante <= 6; dadoAtacante++) {
+            for (int dadoDefensor = 1; dadoDefensor <= 6; dadoDefensor++) {
+                final->vencedoras[k + 6] += dadoAtacante - dadoDefensor > k;
+            }
+        }
+    }
+    return 1;
+}
+
+// chanceFinal():
+// Chance de vencer uma batalha com t tropas contra um alvo com d tropas (mesma regra de resolverAtaque).
+static double chanceFinal(const FinalDeJogo* final, int origem, int alvo, int tropas, int tropasAlvo) {
+    int k = final->bonusAlvo[alvo] + tropasAlvo - final->bonusOrigem[origem] - tropas;
+    if (k < -6) return 1.0;
+    if (k > 6) return 0.0;
+    return final->vencedoras[k + 6] / 36.0;
+}
+
+// ordenarGrupos():
+// Ordena os valores dentro de cada grupo de itens intercambiaveis (grupos contiguos), para que
+// estados que so diferem por uma troca entre eles tenham a mesma chave.
+static void ordenarGrupos(unsigned int* valores, const int* grupo, int quantidade) {
+    for (int i = 1; i < quantidade; i++) {
+        for (int j = i; j > 0 && grupo[j - 1] == grupo[j] && valores[j - 1] < valores[j]; j--) {
+            unsigned int troca = valores[j];
+            valores[j] = valores[j - 1];
+            valores[j - 1] = troca;
+        }
+    }
+}
+
+// chaveFinal():
+// Empacota o estado: tropas de cada origem (8 bits) na palavra baixa, seguidas de tropas (5 bits)
+// e faixa de vida (7 bits) dos dois primeiros alvos; os outros dois alvos vao na palavra alta.
+// Alvos conquistados valem 0. Estados guardados tem alguma origem com 2+ tropas, entao baixa != 0.
+static ChaveFinal chaveFinal(const FinalDeJogo* final, const int* tropasOrigem, const int* tropasAlvo, const int* faixaAlvo) {
+    unsigned int origens[FINAL_MAX_ORIGENS], alvos[FINAL_MAX_ALVOS];
+    for (int o = 0; o < final->numOrigens; o++) {
+        origens[o] = (unsigned int)tropasOrigem[o];
+    }
+    for (int i = 0; i < final->numAlvos; i++) {
+        alvos[i] = faixaAlvo[i] > 0 ? (unsigned int)(tropasAlvo[i] | faixaAlvo[i] << 5) : 0;
+    }
+    ordenarGrupos(origens, final->grupoOrigem, final->numOrigens);
+    ordenarGrupos(alvos, final->grupoAlvo, final->numAlvos);
+    
+    ChaveFinal chave = {0, 0};
+    for (int o = 0; o < final->numOrigens; o++) {
+        chave.baixa |= (unsigned long long)origens[o] << (8 * o);
+    }
+    for (int i = 0; i < final->numAlvos; i++) {
+        if (i < 2) chave.baixa |= (unsigned long long)alvos[i] << (32 + 12 * i);
+        else chave.alta |= (unsigned long long)alvos[i] << (12 * (i - 2));
+    }
+    return chave;
+}
+
+// memoBuscar() / memoGuardar():
+// Consulta e insercao na tabela da thread. A tabela dobra quando passa da metade; alem de
+// FINAL_MAX_ESTADOS ela fica marcada como esgotada e a busca e abandonada.
+static size_t memoPosicao(const MemoFinal* memo, ChaveFinal chave) {
+    unsigned long long hash = (chave.baixa ^ chave.alta * 0xC2B2AE3D27D4EB4FULL) * 0x9E3779B97F4A7C15ULL;
+    size_t i = (size_t)(hash >> 20) & (memo->capacidade - 1);
+    while (memo->chaves[i].baixa != 0 &&
+           (memo->chaves[i].baixa != chave.baixa || memo->chaves[i].alta != chave.alta)) {
+        i = (i + 1) & (memo->capacidade - 1);
+    }
+    return i;
+}
+
+static int memoBuscar(const MemoFinal* memo, ChaveFinal chave, double* valor) {
+    size_t i = memoPosicao(memo, chave);
+    if (memo->chaves[i].baixa == 0) return 0;
+    *valor = memo->valores[i];
+    return 1;
+}
+
+static void memoGuardar(MemoFinal* memo, ChaveFinal chave, double valor) {
+    if ((memo->quantidade + 1) * 2 > memo->capacidade) {
+        if (memo->quantidade >= FINAL_MAX_ESTADOS) {
+            memo->esgotada = 1;
+            return;
+        }
+        MemoFinal maior = {0};
+        maior.capacidade = memo->capacidade * 2;
+        maior.chaves = (ChaveFinal*)calloc(maior.capacidade, sizeof(ChaveFinal));
+        maior.valores = (double*)malloc(maior.capacidade * sizeof(double));
+        if (maior.chaves == NULL || maior.valores == NULL) {
+            free(maior.chaves);
+            free(maior.valores);
+            memo->esgotada = 1;
+            return;
+        }
+        for (size_t i = 0; i < memo->capacidade; i++) {
+            if (memo->chaves[i].baixa != 0) {
+                size_t j = memoPosicao(&maior, memo->chaves[i]);
+                maior.chaves[j] = memo->chaves[i];
+                maior.valores[j] = memo->valores[i];
+            }
+        }
+        maior.quantidade = memo->quantidade;
+        free(memo->chaves);
+        free(memo->valores);
+        *memo = maior;
+    }
+    size_t i = memoPosicao(memo, chave);
+    memo->chaves[i] = chave;
+    memo->valores[i] = valor;
+    memo->quantidade++;
+}
+
+static double valorFinal(const FinalDeJogo* final, MemoFinal* memo, int* tropasOrigem, int* tropasAlvo, int* faixaAlvo);
+
+// valorAtaqueFinal():
+// Chance de cumprir a missao atacando o alvo a partir da origem com t tropas e depois jogando
+// da melhor forma. Vitoria tira t faixas de vida (conquista ao zerar, levando t tropas da
+// origem) e uma tropa do alvo; derrota tira t tropas da origem.
+static double valorAtaqueFinal(const FinalDeJogo* final, MemoFinal* memo, int* tropasOrigem,
+                               int* tropasAlvo, int* faixaAlvo, int origem, int alvo, int t) {
+    double chance = chanceFinal(final, origem, alvo, t, tropasAlvo[alvo]);
+    int tropasAntes = tropasAlvo[alvo];
+    int faixaAntes = faixaAlvo[alvo];
+    int origemAntes = tropasOrigem[origem];
+    double valor = 0;
+    
+    if (chance > 0) {
+        if (faixaAntes <= t) {
+            faixaAlvo[alvo] = 0;
+            tropasOrigem[origem] = origemAntes - t;
+        } else {
+            faixaAlvo[alvo] = faixaAntes - t;
+            tropasAlvo[alvo] = tropasAntes > 1 ? tropasAntes - 1 : 1;
+        }
+        valor += chance * valorFinal(final, memo, tropasOrigem, tropasAlvo, faixaAlvo);
+        tropasAlvo[alvo] = tropasAntes;
+        faixaAlvo[alvo] = faixaAntes;
+        tropasOrigem[origem] = origemAntes;
+    }
+    if (chance < 1) {
+        tropasOrigem[origem] = origemAntes - t;
+        valor += (1 - chance) * valorFinal(final, memo, tropasOrigem, tropasAlvo, faixaAlvo);
+        tropasOrigem[origem] = origemAntes;
+    }
+    return valor;
+}
+
+// valorFinal():
+// Chance exata de cumprir a missao a partir do estado, escolhendo sempre o melhor ataque
+// (origem, alvo e tropas, de 1 ate deixar uma tropa na origem). Todo ataque tira vida do
+// alvo ou tropas da origem, entao a recursao sempre termina.
+// Restricao: so considera t <= tropas da origem - 1 (e <= MAX_TROPAS_ATAQUE). O jogo aceita
+// de 1 a MAX_TROPAS_ATAQUE tropas sem olhar as tropas da origem, e t maior so aumenta a forca
+// do atacante; a chance calculada vale para quem respeita esse limite.
+static double valorFinal(const FinalDeJogo* final, MemoFinal* memo, int* tropasOrigem, int* tropasAlvo, int* faixaAlvo) {
+    int restantes = 0;
+    for (int i = 0; i < final->numAlvos; i++) restantes += faixaAlvo[i] > 0;
+    if (restantes == 0) return 1.0;
+    if (memo->esgotada) return 0.0;
+    
+    int podeAtacar = 0;
+    for (int o = 0; o < final->numOrigens; o++) podeAtacar |= tropasOrigem[o] > 1;
+    if (!podeAtacar) return 0.0;
+    
+    ChaveFinal chave = chaveFinal(final, tropasOrigem, tropasAlvo, faixaAlvo);
+    double melhor;
+    if (memoBuscar(memo, chave, &melhor)) return melhor;
+    
+    melhor = 0;
+    for (int o = 0; o < final->numOrigens && melhor < 1.0; o++) {
+        int maxTropas = tropasOrigem[o] - 1 < MAX_TROPAS_ATAQUE ? tropasOrigem[o] - 1 : MAX_TROPAS_ATAQUE;
+        for (int alvo = 0; alvo < final->numAlvos && melhor < 1.0; alvo++) {
+            if (faixaAlvo[alvo] == 0) continue;
+            for (int t = 1; t <= maxTropas && melhor < 1.0; t++) {
+                double valor = valorAtaqueFinal(final, memo, tropasOrigem, tropasAlvo, faixaAlvo, o, alvo, t);
+                if (valor > melhor) melhor = valor;
+            }
+        }
+    }
+    memoGuardar(memo, chave, melhor);
+    return melhor;
+}
+
+// executarTrabalhoFinal():
+// Corpo das threads do solucionador: cada thread avalia ataques iniciais com sua propria
+// tabela de memorizacao, sem travas, reaproveitando-a entre os ataques que pegar.
+static void* executarTrabalhoFinal(void* argumento) {
+    TrabalhoFinal* trabalho = (TrabalhoFinal*)argumento;
+    const FinalDeJogo* final = trabalho->final;
+    MemoFinal memo = {0};
+    memo.capacidade = 1 << 12;
+    memo.chaves = (ChaveFinal*)calloc(memo.capacidade, sizeof(ChaveFinal));
+    memo.valores = (double*)malloc(memo.capacidade * sizeof(double));
+    if (memo.chaves == NULL || memo.valores == NULL) {
+        memo.esgotada = 1;
+    }
+    
+    int i;
+    while (!memo.esgotada && (i = atomic_fetch_add(&trabalho->proxima, 1)) < trabalho->numAcoes) {
+        AcaoFinal* acao = &trabalho->acoes[i];
+        int tropasOrigem[FINAL_MAX_ORIGENS], tropasAlvo[FINAL_MAX_ALVOS], faixaAlvo[FINAL_MAX_ALVOS];
+        memcpy(tropasOrigem, final->tropasOrigem, sizeof(tropasOrigem));
+        memcpy(tropasAlvo, final->tropasAlvo, sizeof(tropasAlvo));
+        memcpy(faixaAlvo, final->faixaAlvo, sizeof(faixaAlvo));
+        acao->chance = valorAtaqueFinal(final, &memo, tropasOrigem, tropasAlvo, faixaAlvo,
+                                        acao->origem, acao->alvo, acao->tropas);
+    }
+    
+    if (memo.esgotada) atomic_store(&trabalho->esgotado, 1);
+    atomic_fetch_add(&trabalho->estados, (long)memo.quantidade);
+    free(memo.chaves);
+    free(memo.valores);
+    return NULL;
+}
+
+// resolverFinalDeJogo():
+// Avalia todos os ataques iniciais possiveis (origem, alvo, tropas de 1 a tropas da origem - 1,
+// a mesma restricao de valorFinal()) em paralelo e devolve o melhor em 'melhor', com a chance
+// exata de cumprir a missao. Se nao houver alvos restantes a chance e 1 e melhor->alvo fica -1.
+// Retorna 0 se faltar memoria ou a posicao passar de FINAL_MAX_ESTADOS estados em alguma thread.
+int resolverFinalDeJogo(const FinalDeJogo* final, int numThreads, AcaoFinal* melhor, long* estados) {
+    melhor->origem = -1;
+    melhor->alvo = -1;
+    melhor->tropas = 0;
+    melhor->chance = (final->numAlvos == 0) ? 1.0 : 0.0;
+    *estados = 0;
+    if (final->numAlvos == 0 || final->numOrigens == 0) {
+        return 1;
+    }
+    
+    TrabalhoFinal trabalho;
+    trabalho.final = final;
+    trabalho.numAcoes = 0;
+    for (int o = 0; o < final->numOrigens; o++) {
+        int maxTropas = final->tropasOrigem[o] - 1 < MAX_TROPAS_ATAQUE ? final->tropasOrigem[o] - 1 : MAX_TROPAS_ATAQUE;
+        trabalho.numAcoes += final->numAlvos * maxTropas;
+    }
+    trabalho.acoes = (AcaoFinal*)malloc((size_t)trabalho.numAcoes * sizeof(AcaoFinal));
+    if (trabalho.acoes == NULL) {
+        return 0;
+    }
+    int n = 0;
+    for (int o = 0; o < final->numOrigens; o++) {
+        int maxTropas = final->tropasOrigem[o] - 1 < MAX_TROPAS_ATAQUE ? final->tropasOrigem[o] - 1 : MAX_TROPAS_ATAQUE;
+        for (int a = 0; a < final->numAlvos; a++) {
+            for (int t = 1; t <= maxTropas; t++) {
+                trabalho.acoes[n].origem = o;
+                trabalho.acoes[n].alvo = a;
+                trabalho.acoes[n].tropas = t;
+                trabalho.acoes[n].chance = 0;
+                n++;
+            }
+        }
+    }
+    atomic_init(&trabalho.proxima, 0);
+    atomic_init(&trabalho.estados, 0);
+    atomic_init(&trabalho.esgotado, 0);
+    
+    if (numThreads > trabalho.numAcoes) numThreads = trabalho.numAcoes;
+    pthread_t* threads = (pthread_t*)malloc((size_t)numThreads * sizeof(pthread_t));
+    int iniciadas = 0;
+    while (threads != NULL && iniciadas < numThreads &&
+           pthread_create(&threads[iniciadas], NULL, executarTrabalhoFinal, &trabalho) == 0) {
+        iniciadas++;
+    }
+    if (iniciadas == 0) {
+        executarTrabalhoFinal(&trabalho);
+    }
+    for (int i = 0; i < iniciadas; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    
+    for (int i = 0; i < trabalho.numAcoes; i++) {
+        if (melhor->alvo < 0 || trabalho.acoes[i].chance > melhor->chance) {
+            *melhor = trabalho.acoes[i];
+        }
+    }
+    *estados = atomic_load(&trabalho.estados);
+    free(trabalho.acoes);
+    return !atomic_load(&trabalho.esgotado);
+}
+
+// verificarFinalDeJogo():
+// Confere o solucionador por simulacao: joga 'partidas' vezes a partir do mapa seguindo a politica
+// otima (em cada estado, o ataque de maior valorAtaqueFinal()), com as batalhas resolvidas por
+// resolverAtaque() e a missao conferida por verificarVitoria(). As simulacoes nao pontuam nem vao
+// para o exportador de batalhas. Retorna a fracao de partidas em que a missao foi cumprida,
+// ou -1 se faltar memoria ou a tabela passar de FINAL_MAX_ESTADOS estados.
+double verificarFinalDeJogo(const Territorio* mapa, const Jogador* jogador, int idMissao,
+                            const FinalDeJogo* final, int partidas) {
+    const ParametrosCombate* regras = regrasDaThread;
+    MemoFinal memo = {0};
+    memo.capacidade = 1 << 12;
+    memo.chaves = (ChaveFinal*)calloc(memo.capacidade, sizeof(ChaveFinal));
+    memo.valores = (double*)malloc(memo.capacidade * sizeof(double));
+    Territorio* copia = alocarMapa();
+    if (memo.chaves == NULL || memo.valores == NULL || copia == NULL) {
+        free(memo.chaves);
+        free(memo.valores);
+        liberarMemoria(copia);
+        return -1;
+    }
+    
+    ExportadorBatalhas* exportador = exportadorDaThread;
+    exportadorAtivarNaThread(NULL);
+    
+    // A politica so ataca das origens para os alvos do solucionador: o mapa e copiado uma vez
+    // e cada partida restaura apenas esses territorios
+    memcpy(copia, mapa, NUM_TERRITORIOS * sizeof(Territorio));
+    int cumpridas = 0;
+    for (int p = 0; p < partidas && !memo.esgotada; p++) {
+        for (int o = 0; o < final->numOrigens; o++) {
+            copia[final->origens[o]] = mapa[final->origens[o]];
+        }
+        for (int i = 0; i < final->numAlvos; i++) {
+            copia[final->alvos[i]] = mapa[final->alvos[i]];
+        }
+        Jogador simulado = *jogador;
+        simulado.idPlacar = 0;
+        
+        for (;;) {
+            // Estado do solucionador lido do mapa simulado
+            int tropasOrigem[FINAL_MAX_ORIGENS], tropasAlvo[FINAL_MAX_ALVOS], faixaAlvo[FINAL_MAX_ALVOS];
+            for (int o = 0; o < final->numOrigens; o++) {
+                tropasOrigem[o] = copia[final->origens[o]].numTropas;
+            }
+            for (int i = 0; i < final->numAlvos; i++) {
+                const Territorio* alvo = &copia[final->alvos[i]];
+                int faixa = (alvo->vida + regras->danoPorTropa - 1) / regras->danoPorTropa;
+                int conquistado = strcmp(alvo->corExercito, simulado.cor) == 0;
+                tropasAlvo[i] = conquistado ? 0 : (alvo->numTropas > 1 ? alvo->numTropas : 1);
+                faixaAlvo[i] = conquistado ? 0 : (faixa > 1 ? faixa : 1);
+            }
+            
+            int melhorOrigem = -1, melhorAlvo = -1, melhorTropas = 0;
+            double melhor = -1;
+            for (int o = 0; o < final->numOrigens; o++) {
+                int maxTropas = tropasOrigem[o] - 1 < MAX_TROPAS_ATAQUE ? tropasOrigem[o] - 1 : MAX_TROPAS_ATAQUE;
+                for (int alvo = 0; alvo < final->numAlvos; alvo++) {
+                    if (faixaAlvo[alvo] == 0) continue;
+                    for (int t = 1; t <= maxTropas; t++) {
+                        double valor = valorAtaqueFinal(final, &memo, tropasOrigem, tropasAlvo, faixaAlvo, o, alvo, t);
+                        if (valor > melhor) {
+                            melhor = valor;
+                            melhorOrigem = o;
+                            melhorAlvo = alvo;
+                            melhorTropas = t;
+                        }
+                    }
+                }
+            }
+            if (melhorOrigem < 0) break;
+            resolverAtaque(&copia[final->origens[melhorOrigem]], &copia[final->alvos[melhorAlvo]], &simulado, melhorTropas);
+        }
+        cumpridas += verificarVitoria(copia, idMissao, simulado.cor);
+    }
+    
+    exportadorAtivarNaThread(exportador);
+    int esgotada = memo.esgotada;
+    free(memo.chaves);
+    free(memo.valores);
+    liberarMemoria(copia);
+    return (esgotada || partidas <= 0) ? -1 : (double)cumpridas / partidas;
+}
+
+// analisarFinalDeJogo():
+// Opcao do menu: quando faltam poucos territorios para a missao, calcula a chance exata de
+// cumpri-la atacando a partir dos territorios atuais e recomenda o melhor proximo ataque.
+// Com partidasVerificacao > 0, confere a chance com verificarFinalDeJogo().
+void analisarFinalDeJogo(const Territorio* mapa, const Jogador* jogador, int idMissao, int numThreads,
+                         int partidasVerificacao) {
+    FinalDeJogo final;
+    printf("\n=== FINAL DE JOGO (SOLUCAO EXATA) ===\n");
+    if (!prepararFinalDeJogo(mapa, jogador, idMissao, &final)) {
+        return;
+    }
+    
+    printf("Territorios que faltam para a missao:\n");
+    for (int i = 0; i < final.numAlvos; i++) {
+        const Territorio* alvo = &mapa[final.alvos[i]];
+        printf("- %s (%s) | Tropas: %d | Vida: %d | Poder: %d\n",
+               alvo->nome, alvo->corExercito, alvo->numTropas, alvo->vida, alvo->poder);
+    }
+    
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    AcaoFinal melhor;
+    long estados;
+    int resolvido = resolverFinalDeJogo(&final, numThreads, &melhor, &estados);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    if (!resolvido) {
+        printf("Posicao grande demais para a solucao exata (mais de %d estados por thread).\n", FINAL_MAX_ESTADOS);
+        return;
+    }
+    if (final.numAlvos == 0) {
+        printf("Nenhum territorio falta: a missao ja esta cumprida!\n");
+        return;
+    }
+    if (melhor.origem < 0) {
+        printf("Nenhum territorio seu tem tropas para atacar: chance de cumprir a missao 0.00%%.\n");
+        return;
+    }
+    
+    printf("\nChance exata de cumprir a missao: %.2f%%\n", melhor.chance * 100.0);
+    printf("Melhor ataque: %s -> %s com %d tropas\n", mapa[final.origens[melhor.origem]].nome,
+           mapa[final.alvos[melhor.alvo]].nome, melhor.tropas);
+    printf("(%ld estados em %.2f s; considera ataques dos seus %d territorios com mais tropas,\n",
+           estados, segundos, final.numOrigens);
+    printf(" sempre deixando ao menos uma tropa na origem)\n");
+    
+    if (partidasVerificacao > 0) {
+        double simulada = verificarFinalDeJogo(mapa, jogador, idMissao, &final, partidasVerificacao);
+        if (simulada < 0) {
+            printf("Erro: Nao foi possivel alocar memoria para a verificacao!\n");
+        } else {
+            printf("Verificacao: missao cumprida em %.2f%% de %d partidas simuladas com esta politica\n",
+                   simulada * 100.0, partidasVerificacao);
+        }
+    }
+}
+
+// equilibrioDoMapa():
+// Soma a forca (forcaTerritorio()) de cada cor num unico passe e retorna a diferenca entre a
+// cor mais forte e a mais fraca em % da forca media. Retorna INT_MAX se alguma cor nao tiver territorio.
+int equilibrioDoMapa(const Territorio* mapa) {
+    int forca[NUM_CORES] = {0};
+    int territorios[NUM_CORES] = {0};
+    int total = 0;
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        int cor = indiceCor(mapa[i].corExercito);
+        if (cor < 0) continue;
+        int valor = forcaTerritorio(&mapa[i]);
+        forca[cor] += valor;
+        territorios[cor]++;
+        total += valor;
+    }
+    
+    int maior = forca[0], menor = forca[0];
+    for (int c = 0; c < NUM_CORES; c++) {
+        if (territorios[c] == 0) return INT_MAX;
+        if (forca[c] > maior) maior = forca[c];
+        if (forca[c] < menor) menor = forca[c];
+    }
+    return (int)((long)(maior - menor) * 100 * NUM_CORES / total);
+}
+
+// codificarInicio():
+// Registro de um inicio: por territorio, cor (1 byte), tropas (1 byte), vida e poder (16 bits
+// little-endian cada). Os nomes nao sao gravados; seguem a ordem de NOMES_TERRITORIOS.
+static void codificarInicio(unsigned char* registro, const Territorio* mapa) {
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        unsigned char* territorio = registro + i * INICIOS_BYTES_TERRITORIO;
+        territorio[0] = (unsigned char)indiceCor(mapa[i].corExercito);
+        territorio[1] = (unsigned char)mapa[i].numTropas;
+        gravarCurto(territorio + 2, mapa[i].vida);
+        gravarCurto(territorio + 4, mapa[i].poder);
+    }
+}
+
+// inserirHashInicio():
+// Insere o hash no conjunto sem travas. Retorna 1 se o hash era novo e 0 se ja existia
+// (ou se a tabela encheu).
+static int inserirHashInicio(TrabalhoInicios* trabalho, unsigned long long hash) {
+    hash |= 1; // 0 marca posicao vazia
+    size_t i = (size_t)(hash * 0x9E3779B97F4A7C15ULL >> 24) & (trabalho->capacidade - 1);
+    for (size_t tentativas = 0; tentativas < trabalho->capacidade; tentativas++) {
+        unsigned long long atual = atomic_load_explicit(&trabalho->hashes[i], memory_order_relaxed);
+        if (atual == hash) return 0;
+        if (atual == 0) {
+            unsigned long long vazio = 0;
+            if (atomic_compare_exchange_strong_explicit(&trabalho->hashes[i], &vazio, hash,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                return 1;
+            }
+            if (vazio == hash) return 0;
+        }
+        i = (i + 1) & (trabalho->capacidade - 1);
+    }
+    return 0;
+}
+
+// gravarLoteInicios():
+// Reserva posicoes no arquivo para ate 'quantidade' inicios e grava os registros nelas.
+// Retorna 0 quando o alvo ja foi atingido.
+static int gravarLoteInicios(TrabalhoInicios* trabalho, const unsigned char* registros, int quantidade) {
+    long inicio = atomic_load(&trabalho->reservados);
+    long gravar;
+    do {
+        if (inicio >= trabalho->alvo) return 0;
+        gravar = trabalho->alvo - inicio < quantidade ? trabalho->alvo - inicio : quantidade;
+    } while (!atomic_compare_exchange_weak(&trabalho->reservados, &inicio, inicio + gravar));
+    
+    size_t bytes = (size_t)gravar * INICIOS_TAMANHO_REGISTRO;
+    off_t posicao = INICIOS_CABECALHO + (off_t)inicio * INICIOS_TAMANHO_REGISTRO;
+    if (pwrite(trabalho->descritor, registros, bytes, posicao) != (ssize_t)bytes) {
+        atomic_store(&trabalho->falhou, 1);
+        return 0;
+    }
+    return 1;
+}
+
+// executarTrabalhoInicios():
+// Corpo das threads do gerador: sorteia mapas com inicializarTerritorios(), descarta os
+// desequilibrados e os repetidos e grava os aceitos em lotes de INICIOS_LOTE.
+static void* executarTrabalhoInicios(void* argumento) {
+    TrabalhoInicios* trabalho = (TrabalhoInicios*)argumento;
+    unsigned char* lote = (unsigned char*)malloc((size_t)INICIOS_LOTE * INICIOS_TAMANHO_REGISTRO);
+    if (lote == NULL) {
+        atomic_store(&trabalho->falhou, 1);
+        return NULL;
+    }
+    semearAleatorio(trabalho->semente * 1000003ULL + (unsigned long long)atomic_fetch_add(&trabalho->proximaThread, 1));
+    
+    Territorio mapa[NUM_TERRITORIOS];
+    int noLote = 0;
+    long gerados = 0;
+    for (;;) {
+        inicializarTerritorios(mapa, NULL);
+        gerados++;
+        
+        if (equilibrioDoMapa(mapa) <= trabalho->equilibrio) {
+            unsigned char* registro = lote + (size_t)noLote * INICIOS_TAMANHO_REGISTRO;
+            codificarInicio(registro, mapa);
+            
+            unsigned long long hash = 14695981039346656037ULL;
+            for (int b = 0; b < INICIOS_TAMANHO_REGISTRO; b++) {
+                hash = (hash ^ registro[b]) * 1099511628211ULL;
+            }
+            if (inserirHashInicio(trabalho, hash)) {
+                noLote++;
+            } else {
+                atomic_fetch_add_explicit(&trabalho->duplicados, 1, memory_order_relaxed);
+            }
+        }
+        
+        if (noLote == INICIOS_LOTE || (gerados & 1023) == 0) {
+            long total = atomic_fetch_add_explicit(&trabalho->gerados, gerados, memory_order_relaxed) + gerados;
+            gerados = 0;
+            if (noLote > 0 && !gravarLoteInicios(trabalho, lote, noLote)) break;
+            noLote = 0;
+            if (atomic_load(&trabalho->reservados) >= trabalho->alvo || total >= trabalho->maxGerados) break;
+        }
+    }
+    
+    free(lote);
+    return NULL;
+}
+
+// executarGeracaoInicios():
+// Gera 'quantidade' mapas iniciais distintos cuja diferenca de forca entre as cores fique
+// dentro de 'equilibrio' % e grava-os em 'caminho': cabecalho de INICIOS_CABECALHO bytes
+// (magico, versao, territorios, tamanho do registro, equilibrio) seguido dos registros de codificarInicio().
+// Desiste apos INICIOS_MAX_TENTATIVAS mapas sorteados por inicio pedido. Retorna 1 em caso de sucesso.
+int executarGeracaoInicios(const char* caminho, long quantidade, int equilibrio, int numThreads) {
+    TrabalhoInicios trabalho;
+    memset(&trabalho, 0, sizeof(trabalho));
+    trabalho.alvo = quantidade;
+    trabalho.equilibrio = equilibrio;
+    trabalho.maxGerados = quantidade * INICIOS_MAX_TENTATIVAS;
+    trabalho.semente = (unsigned long long)time(NULL);
+    atomic_init(&trabalho.reservados, 0);
+    atomic_init(&trabalho.gerados, 0);
+    atomic_init(&trabalho.duplicados, 0);
+    atomic_init(&trabalho.falhou, 0);
+    atomic_init(&trabalho.proximaThread, 0);
+    
+    // Conjunto de hashes com ao menos o dobro das insercoes possiveis
+    trabalho.capacidade = 1024;
+    while (trabalho.capacidade < 2 * (size_t)(quantidade + (long)numThreads * INICIOS_LOTE)) {
+        trabalho.capacidade *= 2;
+    }
+    trabalho.hashes = (atomic_ullong*)calloc(trabalho.capacidade, sizeof(atomic_ullong));
+    if (trabalho.hashes == NULL) {
+        printf("Erro: Nao foi possivel alocar memoria para o gerador de inicios!\n");
+        return 0;
+    }
+    
+    trabalho.descritor = open(caminho, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (trabalho.descritor < 0) {
+        printf("Erro: Nao foi possivel criar o arquivo %s!\n", caminho);
+        free(trabalho.hashes);
+        return 0;
+    }
+    unsigned char cabecalho[INICIOS_CABECALHO] = {0};
+    gravarInteiro(cabecalho, (int)INICIOS_MAGICO);
+    gravarInteiro(cabecalho + 4, INICIOS_VERSAO);
+    gravarInteiro(cabecalho + 8, NUM_TERRITORIOS);
+    gravarInteiro(cabecalho + 12, INICIOS_TAMANHO_REGISTRO);
+    gravarInteiro(cabecalho + 16, equilibrio);
+    if (pwrite(trabalho.descritor, cabecalho, sizeof(cabecalho), 0) != (ssize_t)sizeof(cabecalho)) {
+        atomic_store(&trabalho.falhou, 1);
+    }
+    
+    printf("Gerando %ld inicios com diferenca de ate %d%% entre as cores, em %d threads...\n",
+           quantidade, equilibrio, numThreads);
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    
+    pthread_t* threads = (pthread_t*)malloc((size_t)numThreads * sizeof(pthread_t));
+    int iniciadas = 0;
+    while (threads != NULL && iniciadas < numThreads &&
+           pthread_create(&threads[iniciadas], NULL, executarTrabalhoInicios, &trabalho) == 0) {
+        iniciadas++;
+    }
+    if (iniciadas == 0) {
+        executarTrabalhoInicios(&trabalho);
+    }
+    for (int i = 0; i < iniciadas; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    long gravados = atomic_load(&trabalho.reservados);
+    long gerados = atomic_load(&trabalho.gerados);
+    
+    int sucesso = !atomic_load(&trabalho.falhou) &&
+                  ftruncate(trabalho.descritor, INICIOS_CABECALHO + (off_t)gravados * INICIOS_TAMANHO_REGISTRO) == 0;
+    if (close(trabalho.descritor) != 0) sucesso = 0;
+    free(trabalho.hashes);
+    
+    printf("%ld inicios gravados de %ld mapas sorteados (%ld repetidos) em %.2f s (%.0f mapas/min).\n",
+           gravados, gerados, atomic_load(&trabalho.duplicados), segundos,
+           segundos > 0 ? gerados * 60.0 / segundos : 0.0);
+    if (!sucesso) {
+        printf("Erro ao gravar o arquivo %s!\n", caminho);
+        return 0;
+    }
+    if (gravados < quantidade) {
+        printf("Aviso: Poucos mapas dentro do equilibrio pedido; tente um --equilibrio maior.\n");
+    }
+    return 1;
+}
+
+// carregarInicio():
+// Le o inicio de numero 'indice' (a partir de 0) de um arquivo do gerador de inicios e devolve
+// em 'equilibrio' a diferenca maxima entre as cores usada na geracao. O registro inteiro e
+// validado antes de alterar 'mapa'.
+// Retorna 0 se o arquivo nao existir, for de outro formato ou nao tiver esse indice.
+int carregarInicio(const char* caminho, long indice, Territorio* mapa, int* equilibrio) {
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) return 0;
+    
+    unsigned char cabecalho[INICIOS_CABECALHO];
+    unsigned char registro[INICIOS_TAMANHO_REGISTRO];
+    int lido = pread(descritor, cabecalho, sizeof(cabecalho), 0) == (ssize_t)sizeof(cabecalho) &&
+               (unsigned int)lerInteiro(cabecalho) == INICIOS_MAGICO &&
+               lerInteiro(cabecalho + 4) == INICIOS_VERSAO &&
+               lerInteiro(cabecalho + 8) == NUM_TERRITORIOS &&
+               lerInteiro(cabecalho + 12) == INICIOS_TAMANHO_REGISTRO &&
+               pread(descritor, registro, sizeof(registro),
+                     INICIOS_CABECALHO + (off_t)indice * INICIOS_TAMANHO_REGISTRO) == (ssize_t)sizeof(registro);
+    close(descritor);
+    if (!lido) return 0;
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        if (registro[i * INICIOS_BYTES_TERRITORIO] >= NUM_CORES) return 0;
+    }
+    
+    for (int i = 0; i < NUM_TERRITORIOS; i++) {
+        const unsigned char* territorio = registro + i * INICIOS_BYTES_TERRITORIO;
+        strcpy(mapa[i].nome, NOMES_TERRITORIOS[i]);
+        strcpy(mapa[i].corExercito, NOMES_CORES[territorio[0]]);
+        mapa[i].numTropas = territorio[1];
+        mapa[i].vida = territorio[2] | territorio[3] << 8;
+        mapa[i].poder = territorio[4] | territorio[5] << 8;
+    }
+    *equilibrio = lerInteiro(cabecalho + 16);
+    return 1;
 }